@@ -157,36 +157,17 @@ void rst::rasterizer::draw(rst::pos_buf_id pos_buffer, rst::ind_buf_id ind_buffe
 
     Eigen::Matrix4f mvp = projection * view * model;
 
+    //所有顶点一次性做 mvp、齐次除法（经过了 mvp 之后, 向量的其次坐标的 w 都不再是 1 了, 归一化）和视口变换，
+    //被多个三角形共用的顶点只算一次
+    project_vertices(mvp, buf.data(), buf.size(), width, height, f1, f2, screen_buf);
+
     for (auto& i : ind)
     {
         Triangle t;
 
-        //三个 mvp 后的顶点
-        Eigen::Vector4f v[] = {
-                mvp * to_vec4(buf[i[0]], 1.0f),
-                mvp * to_vec4(buf[i[1]], 1.0f),
-                mvp * to_vec4(buf[i[2]], 1.0f)
-        };
-
-        //hormogenies coordinate
-        //经过了 mvp 之后, 向量的其次坐标的 w 都不再是 1 了, 归一化
-        for (auto& vec : v) {
-            vec /= vec.w();
-        }
-        //hormogenies coordinate
-        //Viewport transformation
-        for (auto & vert : v)
-        {
-            vert.x() = 0.5*width*vert.x() + 0.5*width;
-            vert.y() = 0.5*height*vert.y() + 0.5*height;
-            vert.z() = vert.z() * f1 + f2;//????S
-        }
-
-        for (int i = 0; i < 3; ++i)
+        for (int k = 0; k < 3; ++k)
         {
-            t.setVertex(i, v[i].head<3>());
-            t.setVertex(i, v[i].head<3>());
-            t.setVertex(i, v[i].head<3>());
+            t.setVertex(k, Eigen::Vector3f(screen_buf.x[i[k]], screen_buf.y[i[k]], screen_buf.z[i[k]]));
         }
 
         t.setColor(0, 255.0,  0.0,  0.0);
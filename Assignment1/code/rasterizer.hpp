@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Triangle.hpp"
+#include "vertex_transform.hpp"
 #include <algorithm>
 #include <eigen3/Eigen/Eigen>
 using namespace Eigen;
@@ -82,6 +83,9 @@ class rasterizer
 
     std::vector<Eigen::Vector3f> frame_buf;//color
     std::vector<float> depth_buf;//depth
+
+    //draw 时顶点变换到屏幕空间的结果，跨帧复用
+    VertexArrays screen_buf;
     
     int get_index(int x, int y);
 
@@ -80,32 +80,17 @@ void rst::rasterizer::draw(pos_buf_id pos_buffer, ind_buf_id ind_buffer, col_buf
     float f2 = (50 + 0.1) / 2.0;
 
     Eigen::Matrix4f mvp = projection * view * model;
-	
+
+    //MVP、Homogeneous division、Viewport transformation 对整个顶点数组一次完成，共用的顶点只算一次
+    project_vertices(mvp, buf.data(), buf.size(), width, height, f1, f2, screen_buf);
+
     for (auto& i : ind)
     {
         Triangle t;
-        Eigen::Vector4f v[] = {
-                mvp * to_vec4(buf[i[0]], 1.0f),
-                mvp * to_vec4(buf[i[1]], 1.0f),
-                mvp * to_vec4(buf[i[2]], 1.0f)
-        };
-        //Homogeneous division
-        for (auto& vec : v) {
-            vec /= vec.w();
-        }
-        //Viewport transformation
-        for (auto & vert : v)
-        {
-            vert.x() = 0.5*width*(vert.x()+1.0);
-            vert.y() = 0.5*height*(vert.y()+1.0);
-            vert.z() = vert.z() * f1 + f2;
-        }
 
-        for (int i = 0; i < 3; ++i)
+        for (int k = 0; k < 3; ++k)
         {
-            t.setVertex(i, v[i].head<3>());
-            t.setVertex(i, v[i].head<3>());
-            t.setVertex(i, v[i].head<3>());
+            t.setVertex(k, Eigen::Vector3f(screen_buf.x[i[k]], screen_buf.y[i[k]], screen_buf.z[i[k]]));
         }
 
         auto col_x = col[i[0]];
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include "global.hpp"
 #include "Triangle.hpp"
+#include "vertex_transform.hpp"
 using namespace Eigen;
 
 namespace rst
@@ -92,6 +93,9 @@ namespace rst
         std::vector<Eigen::Vector3f> frame_buf;
 
         std::vector<float> depth_buf;
+
+        // draw 时顶点变换到屏幕空间的结果，跨帧复用
+        VertexArrays screen_buf;
         int get_index(int x, int y);
 
         int width, height;
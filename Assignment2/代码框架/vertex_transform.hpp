@@ -0,0 +1,85 @@
+//
+// 批量顶点变换：整个顶点数组一次遍历完成 MVP、透视除法和视口变换
+//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <eigen3/Eigen/Eigen>
+
+namespace rst {
+
+// SoA 存放的齐次坐标，x / y / z / w 各自连续，循环可以按顶点方向做 SIMD
+struct VertexArrays
+{
+    std::vector<float> x, y, z, w;
+
+    void resize(std::size_t n)
+    {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        w.resize(n);
+    }
+
+    std::size_t size() const { return x.size(); }
+
+    Eigen::Vector4f operator[](std::size_t i) const { return {x[i], y[i], z[i], w[i]}; }
+};
+
+// out[i] = m * (in[i].x, in[i].y, in[i].z, w_in)；点取 w_in = 1，法线等方向取 0。
+// Vec 只需要提供 x() / y() / z()（Vector3f 或 Vector4f）
+template <typename Vec>
+void transform_points(const Eigen::Matrix4f& m, const Vec* in, std::size_t n, float w_in,
+                      VertexArrays& out)
+{
+    out.resize(n);
+    const float m00 = m(0,0), m01 = m(0,1), m02 = m(0,2), m03 = m(0,3) * w_in;
+    const float m10 = m(1,0), m11 = m(1,1), m12 = m(1,2), m13 = m(1,3) * w_in;
+    const float m20 = m(2,0), m21 = m(2,1), m22 = m(2,2), m23 = m(2,3) * w_in;
+    const float m30 = m(3,0), m31 = m(3,1), m32 = m(3,2), m33 = m(3,3) * w_in;
+    float* __restrict ox = out.x.data();
+    float* __restrict oy = out.y.data();
+    float* __restrict oz = out.z.data();
+    float* __restrict ow = out.w.data();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const float px = in[i].x(), py = in[i].y(), pz = in[i].z();
+        ox[i] = m00 * px + m01 * py + m02 * pz + m03;
+        oy[i] = m10 * px + m11 * py + m12 * pz + m13;
+        oz[i] = m20 * px + m21 * py + m22 * pz + m23;
+        ow[i] = m30 * px + m31 * py + m32 * pz + m33;
+    }
+}
+
+// 顶点着色的全部几何部分：MVP -> /w -> 视口。
+// x / y 变到 [0, width] x [0, height]，z 从 [-1, 1] 变到 z * f1 + f2，w 保留裁剪空间的 w（透视矫正插值要用）
+template <typename Vec>
+void project_vertices(const Eigen::Matrix4f& mvp, const Vec* in, std::size_t n,
+                      int width, int height, float f1, float f2, VertexArrays& out)
+{
+    out.resize(n);
+    const Eigen::Matrix4f& m = mvp;
+    const float m00 = m(0,0), m01 = m(0,1), m02 = m(0,2), m03 = m(0,3);
+    const float m10 = m(1,0), m11 = m(1,1), m12 = m(1,2), m13 = m(1,3);
+    const float m20 = m(2,0), m21 = m(2,1), m22 = m(2,2), m23 = m(2,3);
+    const float m30 = m(3,0), m31 = m(3,1), m32 = m(3,2), m33 = m(3,3);
+    const float half_width = 0.5f * width, half_height = 0.5f * height;
+    float* __restrict ox = out.x.data();
+    float* __restrict oy = out.y.data();
+    float* __restrict oz = out.z.data();
+    float* __restrict ow = out.w.data();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const float px = in[i].x(), py = in[i].y(), pz = in[i].z();
+        const float cw = m30 * px + m31 * py + m32 * pz + m33;
+        const float rw = 1.0f / cw;
+        ox[i] = half_width * ((m00 * px + m01 * py + m02 * pz + m03) * rw + 1.0f);
+        oy[i] = half_height * ((m10 * px + m11 * py + m12 * pz + m13) * rw + 1.0f);
+        oz[i] = (m20 * px + m21 * py + m22 * pz + m23) * rw * f1 + f2;
+        ow[i] = cw;
+    }
+}
+
+} // namespace rst
@@ -78,65 +78,42 @@ void rst::rasterizer::draw(std::vector<Triangle *> &TriangleList) {
     Eigen::Matrix4f mvp = projection * view * model;
     //因为重心坐标在投影坐标下会发生变换，没有projection是为了后面三角形内部重心坐标与纹理重心坐标对应
     Eigen::Matrix4f mv = view * model;
-    for (const auto& t:TriangleList)
+    //法线变换矩阵对所有三角形都一样，只求一次逆
+    Eigen::Matrix4f inv_trans = mv.inverse().transpose();
+
+    //所有三角形的顶点、法线按 3 * 三角形下标 + 顶点下标 收集到连续数组里，一次批量变换
+    const std::size_t n = TriangleList.size() * 3;
+    vertex_buf.resize(n);
+    normal_buf.resize(n);
+    for (std::size_t i = 0; i < TriangleList.size(); ++i)
     {
-        Triangle newtri = *t;
-
-        //mv 空间坐标
-        std::array<Eigen::Vector4f, 3> mm {
-            (mv * t->v[0]),
-            (mv * t->v[1]),
-            (mv * t->v[2])
-        };
-
-        std::array<Eigen::Vector3f, 3> viewspace_pos;
-
-        // vector4f 转 vector3f
-        std::transform(mm.begin(), mm.end(), viewspace_pos.begin(), 
-            [](auto& v) { return v.template head<3>();}
-        );
-
-        //mvp 坐标
-        Eigen::Vector4f v[] = {
-                mvp * t->v[0],
-                mvp * t->v[1],
-                mvp * t->v[2]
-        };
-        
-        //Homogeneous division
-        for (auto& vec : v) {
-            vec.x()/=vec.w();
-            vec.y()/=vec.w();
-            vec.z()/=vec.w();
+        for (int k = 0; k < 3; ++k)
+        {
+            vertex_buf[3 * i + k] = TriangleList[i]->v[k].head<3>();
+            normal_buf[3 * i + k] = TriangleList[i]->normal[k];
         }
+    }
 
-        Eigen::Matrix4f inv_trans = (view * model).inverse().transpose();
-        Eigen::Vector4f n[] = {
-                inv_trans * to_vec4(t->normal[0], 0.0f),
-                inv_trans * to_vec4(t->normal[1], 0.0f),
-                inv_trans * to_vec4(t->normal[2], 0.0f)
-        };
+    //mv 空间坐标
+    transform_points(mv, vertex_buf.data(), n, 1.0f, viewspace_buf);
+    //mvp 坐标 -> Homogeneous division -> Viewport transformation（w 保留）
+    project_vertices(mvp, vertex_buf.data(), n, width, height, f1, f2, screen_buf);
+    //view space normal
+    transform_points(inv_trans, normal_buf.data(), n, 0.0f, view_normal_buf);
 
-        //Viewport transformation
-        for (auto & vert : v)
-        {
-            vert.x() = 0.5*width*(vert.x()+1.0);
-            vert.y() = 0.5*height*(vert.y()+1.0);
-            vert.z() = vert.z() * f1 + f2;
-        }
+    for (std::size_t i = 0; i < TriangleList.size(); ++i)
+    {
+        Triangle newtri = *TriangleList[i];
+        std::array<Eigen::Vector3f, 3> viewspace_pos;
 
-        //设置三角形顶点坐标
-        for (int i = 0; i < 3; ++i)
+        for (int k = 0; k < 3; ++k)
         {
+            const std::size_t j = 3 * i + k;
             //screen space coordinates
-            newtri.setVertex(i, v[i]);
-        }
-
-        //设置三角形顶点法线
-        for (int i = 0; i < 3; ++i)
-        {
+            newtri.setVertex(k, screen_buf[j]);
             //view space normal
-            newtri.setNormal(i, n[i].head<3>());
+            newtri.setNormal(k, Eigen::Vector3f(view_normal_buf.x[j], view_normal_buf.y[j], view_normal_buf.z[j]));
+            viewspace_pos[k] = Eigen::Vector3f(viewspace_buf.x[j], viewspace_buf.y[j], viewspace_buf.z[j]);
         }
 
         //设置三角形顶点颜色
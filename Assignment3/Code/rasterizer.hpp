@@ -10,6 +10,7 @@
 #include "global.hpp"
 #include "Shader.hpp"
 #include "Triangle.hpp"
+#include "vertex_transform.hpp"
 
 using namespace Eigen;
 
@@ -112,6 +113,13 @@ namespace rst
 
         std::vector<Eigen::Vector3f> frame_buf;//帧缓存，光栅化的结果就是这里
         std::vector<float> depth_buf;
+
+        // draw 时批量变换用的顶点数组，跨帧复用
+        std::vector<Eigen::Vector3f> vertex_buf;
+        std::vector<Eigen::Vector3f> normal_buf;
+        VertexArrays screen_buf;
+        VertexArrays viewspace_buf;
+        VertexArrays view_normal_buf;
         int get_index(int x, int y);
 
         int width, height;
@@ -0,0 +1,232 @@
+#include "curve.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+cv::Point2f de_casteljau(const cv::Point2f *points, int n, float t, cv::Point2f *scratch)
+{
+    std::copy(points, points + n, scratch);
+    // 第 r 层只剩 n - r 个点，覆盖在前面
+    for (int r = 1; r < n; r++)
+    {
+        for (int i = 0; i < n - r; i++)
+        {
+            scratch[i] = scratch[i] + t * (scratch[i + 1] - scratch[i]);
+        }
+    }
+    return scratch[0];
+}
+
+cv::Point2f de_casteljau(const std::vector<cv::Point2f> &points, float t)
+{
+    const int n = (int)points.size();
+    if (n <= 32)
+    {
+        cv::Point2f scratch[32];
+        return de_casteljau(points.data(), n, t, scratch);
+    }
+    thread_local std::vector<cv::Point2f> scratch;
+    scratch.resize(n);
+    return de_casteljau(points.data(), n, t, scratch.data());
+}
+
+void split_bezier(const cv::Point2f *points, int n, float t, cv::Point2f *left, cv::Point2f *right)
+{
+    if (right != points)
+    {
+        std::copy(points, points + n, right);
+    }
+    // 原地做 de Casteljau：第 r 层的第一个点是左半段的第 r 个控制点；
+    // 每一层的最后一个点不再被覆盖，最后 right[j] 正好是右半段的第 j 个控制点
+    for (int r = 1; r < n; r++)
+    {
+        left[r - 1] = right[0];
+        for (int i = 0; i < n - r; i++)
+        {
+            right[i] = right[i] + t * (right[i + 1] - right[i]);
+        }
+    }
+    left[n - 1] = right[0];
+}
+
+PowerBasis::PowerBasis(const std::vector<cv::Point2f> &points)
+{
+    // c_k = C(n-1, k) * sum_{i<=k} (-1)^(k-i) C(k, i) P_i，用双精度算完再转成单精度
+    const int n = (int)points.size();
+    cx.resize(n);
+    cy.resize(n);
+    double outer = 1; // C(n-1, k)
+    for (int k = 0; k < n; k++)
+    {
+        double sx = 0, sy = 0, inner = 1; // C(k, i)
+        for (int i = 0; i <= k; i++)
+        {
+            double sign = (k - i) % 2 ? -1 : 1;
+            sx += sign * inner * points[i].x;
+            sy += sign * inner * points[i].y;
+            inner = inner * (k - i) / (i + 1);
+        }
+        cx[k] = (float)(outer * sx);
+        cy[k] = (float)(outer * sy);
+        outer = outer * (n - 1 - k) / (k + 1);
+    }
+}
+
+cv::Point2f PowerBasis::evaluate(float t) const
+{
+    const int n = size();
+    float x = cx[n - 1], y = cy[n - 1];
+    for (int k = n - 2; k >= 0; k--)
+    {
+        x = x * t + cx[k];
+        y = y * t + cy[k];
+    }
+    return {x, y};
+}
+
+void PowerBasis::evaluate(const float *t, std::size_t count, float *x, float *y) const
+{
+    const int n = size();
+    // 分块处理，每一块的 x / y / t 在 Horner 的 n 层之间一直留在缓存里
+    const std::size_t block = 256;
+    for (std::size_t begin = 0; begin < count; begin += block)
+    {
+        const std::size_t end = std::min(count, begin + block);
+        for (std::size_t i = begin; i < end; i++)
+        {
+            x[i] = cx[n - 1];
+            y[i] = cy[n - 1];
+        }
+        for (int k = n - 2; k >= 0; k--)
+        {
+            const float ax = cx[k], ay = cy[k];
+            for (std::size_t i = begin; i < end; i++)
+            {
+                x[i] = x[i] * t[i] + ax;
+                y[i] = y[i] * t[i] + ay;
+            }
+        }
+    }
+}
+
+PowerBasisBatch::PowerBasisBatch(const std::vector<std::vector<cv::Point2f>> &points)
+    : curves((int)points.size()), n(points.empty() ? 0 : (int)points[0].size())
+{
+    cx.resize((std::size_t)n * curves);
+    cy.resize((std::size_t)n * curves);
+    for (int c = 0; c < curves; c++)
+    {
+        PowerBasis basis(points[c]);
+        for (int k = 0; k < n; k++)
+        {
+            cx[(std::size_t)k * curves + c] = basis.cx[k];
+            cy[(std::size_t)k * curves + c] = basis.cy[k];
+        }
+    }
+}
+
+void PowerBasisBatch::evaluate(float t, float *x, float *y) const
+{
+    if (n == 0)
+    {
+        return;
+    }
+    const float *top_x = &cx[(std::size_t)(n - 1) * curves], *top_y = &cy[(std::size_t)(n - 1) * curves];
+    std::copy(top_x, top_x + curves, x);
+    std::copy(top_y, top_y + curves, y);
+    for (int k = n - 2; k >= 0; k--)
+    {
+        const float *ax = &cx[(std::size_t)k * curves], *ay = &cy[(std::size_t)k * curves];
+        for (int c = 0; c < curves; c++)
+        {
+            x[c] = x[c] * t + ax[c];
+            y[c] = y[c] * t + ay[c];
+        }
+    }
+}
+
+void PowerBasisBatch::evaluate(const float *t, std::size_t count, float *x, float *y) const
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        evaluate(t[i], x + i * curves, y + i * curves);
+    }
+}
+
+void uniform_parameters(std::size_t count, std::vector<float> &t)
+{
+    t.resize(count);
+    const float step = count > 1 ? 1.0f / (count - 1) : 0.0f;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        t[i] = i * step;
+    }
+}
+
+// 点 p 到线段 ab 的距离的平方
+static float distance2_to_segment(const cv::Point2f &p, const cv::Point2f &a, const cv::Point2f &b)
+{
+    cv::Point2f ab = b - a, ap = p - a;
+    float len2 = ab.dot(ab);
+    float s = len2 > 0 ? std::min(std::max(ap.dot(ab) / len2, 0.0f), 1.0f) : 0.0f;
+    cv::Point2f d = ap - s * ab;
+    return d.dot(d);
+}
+
+static bool is_flat(const cv::Point2f *points, int n, float tolerance2)
+{
+    for (int i = 1; i < n - 1; i++)
+    {
+        if (distance2_to_segment(points[i], points[0], points[n - 1]) > tolerance2)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// scratch 每一层用 2n 个点存左右两半，更深的层从 scratch + 2n 开始，左半段递归完之后右半段复用同一块
+static void flatten_recursive(const cv::Point2f *points, int n, float tolerance2, int depth,
+                              cv::Point2f *scratch, std::vector<cv::Point2f> &out)
+{
+    if (depth == 0 || is_flat(points, n, tolerance2))
+    {
+        out.push_back(points[n - 1]);
+        return;
+    }
+    cv::Point2f *left = scratch, *right = scratch + n;
+    split_bezier(points, n, 0.5f, left, right);
+    flatten_recursive(left, n, tolerance2, depth - 1, scratch + 2 * n, out);
+    flatten_recursive(right, n, tolerance2, depth - 1, scratch + 2 * n, out);
+}
+
+void flatten_bezier(const std::vector<cv::Point2f> &points, float tolerance,
+                    std::vector<cv::Point2f> &out)
+{
+    const int n = (int)points.size();
+    if (n == 0)
+    {
+        return;
+    }
+    out.push_back(points[0]);
+    if (n == 1)
+    {
+        return;
+    }
+    // 每细分一次误差大约变为 1/4，16 层足够把屏幕上的曲线展平到亚像素
+    const int max_depth = 16;
+    thread_local std::vector<cv::Point2f> scratch;
+    scratch.resize((std::size_t)2 * n * max_depth);
+    flatten_recursive(points.data(), n, tolerance * tolerance, max_depth, scratch.data(), out);
+}
+
+float control_polygon_length(const std::vector<cv::Point2f> &points)
+{
+    float length = 0;
+    for (std::size_t i = 1; i < points.size(); i++)
+    {
+        cv::Point2f d = points[i] - points[i - 1];
+        length += std::sqrt(d.dot(d));
+    }
+    return length;
+}
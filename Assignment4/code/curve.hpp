@@ -0,0 +1,66 @@
+#ifndef BEZIER_CURVE_HPP
+#define BEZIER_CURVE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// 任意阶 Bezier 曲线的求值与展平，控制点个数 n（n - 1 阶）不限。
+// 除了输出数组，求值过程中不做任何内存分配
+
+// de Casteljau：在 scratch（至少 n 个点）里原地逐层插值，返回 B(t)
+cv::Point2f de_casteljau(const cv::Point2f *points, int n, float t, cv::Point2f *scratch);
+
+// 同上，n 不超过 32 时用栈上的临时数组
+cv::Point2f de_casteljau(const std::vector<cv::Point2f> &points, float t);
+
+// 在 t 处把曲线分成两段：left 为 [0, t] 段的 n 个控制点，right 为 [t, 1] 段的 n 个控制点。
+// right 可以与 points 相同
+void split_bezier(const cv::Point2f *points, int n, float t, cv::Point2f *left, cv::Point2f *right);
+
+// 幂基（单项式）形式 B(t) = sum c_k t^k，系数由 Bernstein 形式一次性换算，之后用 Horner 求值。
+// 单精度下误差随阶数增长很快（16 个控制点时在 700 像素的窗口里已达数十像素），控制点多于 8 个时用 de Casteljau
+struct PowerBasis
+{
+    std::vector<float> cx, cy; // c_0 .. c_{n-1}
+
+    explicit PowerBasis(const std::vector<cv::Point2f> &points);
+
+    int size() const { return (int)cx.size(); }
+
+    cv::Point2f evaluate(float t) const;
+
+    // 一批参数同时求值：x[i], y[i] = B(t[i])。Horner 的每一层都是对整批 t 的同一个乘加，循环可以向量化
+    void evaluate(const float *t, std::size_t count, float *x, float *y) const;
+};
+
+// 多条同阶曲线一起求值：系数按 SoA 排列，第 k 个系数的所有曲线连续存放在 cx[k * curves + c]。
+// Horner 的每一层是对所有曲线的同一个乘加，最内层循环跨曲线，可以向量化
+struct PowerBasisBatch
+{
+    int curves = 0, n = 0;      // 曲线条数、每条曲线的控制点个数
+    std::vector<float> cx, cy; // n * curves 个系数
+
+    // 所有曲线的控制点个数必须相同
+    explicit PowerBasisBatch(const std::vector<std::vector<cv::Point2f>> &curves);
+
+    // 所有曲线在同一个 t 处求值：x[c], y[c] = B_c(t)
+    void evaluate(float t, float *x, float *y) const;
+
+    // 一批参数：第 c 条曲线在 t[i] 处的结果写入 x[i * curves + c], y[i * curves + c]
+    void evaluate(const float *t, std::size_t count, float *x, float *y) const;
+};
+
+// 均匀分布的 count 个参数 t_i = i / (count - 1)
+void uniform_parameters(std::size_t count, std::vector<float> &t);
+
+// 自适应细分：把曲线展平成折线，折线与曲线的距离不超过 tolerance（像素）。
+// 内部控制点到弦的距离都不超过 tolerance 时曲线整体（在控制多边形的凸包里）离弦也不超过 tolerance，
+// 否则在 t = 0.5 处一分为二继续。结果追加到 out：起点加上每一段的终点
+void flatten_bezier(const std::vector<cv::Point2f> &points, float tolerance,
+                    std::vector<cv::Point2f> &out);
+
+// 控制多边形的长度，曲线长度的上界
+float control_polygon_length(const std::vector<cv::Point2f> &points);
+
+#endif //BEZIER_CURVE_HPP
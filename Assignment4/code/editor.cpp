@@ -0,0 +1,277 @@
+#include "editor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "curve.hpp"
+
+static const float kTolerance = 0.2f;   // 展平误差（像素）
+static const float kStrokeWidth = 1.5f;
+static const int kMargin = 6;           // 控制点标记的半径加线宽，包围盒外扩这么多
+static const float kPickRadius = 8.0f;
+
+CurveEditor::CurveEditor(int width, int height)
+    : curves(1), canvas(height, width, CV_8UC3, cv::Scalar(0))
+{
+}
+
+void CurveEditor::invalidate(const cv::Rect &rect)
+{
+    dirty_region = dirty_region.empty() ? rect : (dirty_region | rect);
+}
+
+void CurveEditor::set_active(int c)
+{
+    if (c == active)
+    {
+        return;
+    }
+    // 当前曲线的控制点颜色不同，新旧两条曲线都要重画
+    for (int k : {active, c})
+    {
+        for (const Segment &segment : curves[k].segments)
+        {
+            invalidate(segment.bounds);
+        }
+    }
+    active = c;
+}
+
+void CurveEditor::refresh_bounds(Segment &segment, const Curve &curve)
+{
+    float x0 = 1e30f, y0 = 1e30f, x1 = -1e30f, y1 = -1e30f;
+    for (int i = segment.first; i < segment.first + segment.count; i++)
+    {
+        const cv::Point2f &p = curve.points[i];
+        x0 = std::min(x0, p.x);
+        y0 = std::min(y0, p.y);
+        x1 = std::max(x1, p.x);
+        y1 = std::max(y1, p.y);
+    }
+    int left = (int)std::floor(x0) - kMargin, top = (int)std::floor(y0) - kMargin;
+    segment.bounds = cv::Rect(left, top, (int)std::ceil(x1) + kMargin + 1 - left,
+                              (int)std::ceil(y1) + kMargin + 1 - top) &
+                     cv::Rect(0, 0, canvas.cols, canvas.rows);
+}
+
+void CurveEditor::rebuild_segments(Curve &curve)
+{
+    for (const Segment &segment : curve.segments)
+    {
+        invalidate(segment.bounds);
+    }
+    curve.segments.clear();
+    const int n = (int)curve.points.size();
+    if (n > 0)
+    {
+        // 分段三次：第 k 段为控制点 [3k, 3k + 3]，最后不足 4 个点的一段按低阶曲线画
+        const int step = curve.piecewise ? 3 : std::max(n - 1, 1);
+        for (int first = 0; first == 0 || first < n - 1; first += step)
+        {
+            Segment segment;
+            segment.first = first;
+            segment.count = std::min(step + 1, n - first);
+            segment.dirty = true;
+            refresh_bounds(segment, curve);
+            invalidate(segment.bounds);
+            curve.segments.push_back(segment);
+        }
+    }
+    curve.polyline_dirty = true;
+}
+
+void CurveEditor::move_point(int c, int i, const cv::Point2f &position)
+{
+    Curve &curve = curves[c];
+    if (i >= (int)curve.points.size())
+    {
+        return;
+    }
+    curve.points[i] = position;
+    for (Segment &segment : curve.segments)
+    {
+        if (i >= segment.first && i < segment.first + segment.count)
+        {
+            invalidate(segment.bounds);
+            refresh_bounds(segment, curve);
+            invalidate(segment.bounds);
+            segment.dirty = true;
+            curve.polyline_dirty = true;
+        }
+    }
+}
+
+bool CurveEditor::pick(const cv::Point2f &p, float radius, int &curve, int &point) const
+{
+    float best = radius * radius;
+    bool found = false;
+    for (int c = 0; c < (int)curves.size(); c++)
+    {
+        for (int i = 0; i < (int)curves[c].points.size(); i++)
+        {
+            cv::Point2f d = curves[c].points[i] - p;
+            if (d.dot(d) <= best)
+            {
+                best = d.dot(d);
+                curve = c;
+                point = i;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+void CurveEditor::on_mouse(int event, int x, int y)
+{
+    const cv::Point2f p(x, y);
+    if (event == cv::EVENT_LBUTTONDOWN)
+    {
+        if (pick(p, kPickRadius, drag_curve, drag_point))
+        {
+            set_active(drag_curve);
+            return;
+        }
+        curves[active].points.push_back(p);
+        rebuild_segments(curves[active]);
+    }
+    else if (event == cv::EVENT_MOUSEMOVE && drag_curve >= 0)
+    {
+        move_point(drag_curve, drag_point, p);
+    }
+    else if (event == cv::EVENT_LBUTTONUP)
+    {
+        drag_curve = drag_point = -1;
+    }
+    else if (event == cv::EVENT_RBUTTONDOWN)
+    {
+        on_key('n');
+    }
+}
+
+bool CurveEditor::on_key(int key)
+{
+    Curve &curve = curves[active];
+    switch (key)
+    {
+    case 27:
+        return false;
+    case 'n':
+        if (!curve.points.empty())
+        {
+            curves.emplace_back();
+            set_active((int)curves.size() - 1);
+        }
+        break;
+    case 'm':
+        curve.piecewise = !curve.piecewise;
+        rebuild_segments(curve);
+        break;
+    case 'x':
+        if (!curve.points.empty())
+        {
+            curve.points.pop_back();
+            // 拖动中的点可能刚好被删掉
+            drag_curve = drag_point = -1;
+            rebuild_segments(curve);
+        }
+        break;
+    case 'c':
+        curves.assign(1, Curve());
+        active = 0;
+        drag_curve = drag_point = -1;
+        invalidate(cv::Rect(0, 0, canvas.cols, canvas.rows));
+        break;
+    case 's':
+        cv::imwrite("my_bezier_curve.png", canvas);
+        break;
+    }
+    return true;
+}
+
+bool CurveEditor::update()
+{
+    last_flattened = 0;
+    for (Curve &curve : curves)
+    {
+        for (Segment &segment : curve.segments)
+        {
+            if (!segment.dirty)
+            {
+                continue;
+            }
+            std::vector<cv::Point2f> points(curve.points.begin() + segment.first,
+                                            curve.points.begin() + segment.first + segment.count);
+            segment.polyline.clear();
+            flatten_bezier(points, kTolerance, segment.polyline);
+            segment.dirty = false;
+            last_flattened++;
+        }
+        if (curve.polyline_dirty)
+        {
+            // 相邻段的首尾是同一个点，只保留一次
+            curve.polyline.clear();
+            for (const Segment &segment : curve.segments)
+            {
+                curve.polyline.insert(curve.polyline.end(),
+                                      segment.polyline.begin() + (curve.polyline.empty() ? 0 : 1),
+                                      segment.polyline.end());
+            }
+            curve.polyline_dirty = false;
+        }
+    }
+
+    last_redrawn_pixels = 0;
+    if (dirty_region.empty())
+    {
+        return false;
+    }
+    cv::Rect region = dirty_region & cv::Rect(0, 0, canvas.cols, canvas.rows);
+    dirty_region = cv::Rect();
+    redraw(region);
+    last_redrawn_pixels = region.area();
+    return true;
+}
+
+void CurveEditor::redraw(const cv::Rect &region)
+{
+    if (region.empty())
+    {
+        return;
+    }
+    // 在 region 的子图上画，OpenCV 自动裁剪；坐标减去 region 的左上角
+    cv::Mat roi = canvas(region);
+    roi.setTo(cv::Scalar(0));
+    const cv::Point offset(region.x, region.y);
+    auto local = [&](const cv::Point2f &p) {
+        return cv::Point((int)std::lround(p.x) - offset.x, (int)std::lround(p.y) - offset.y);
+    };
+
+    for (int c = 0; c < (int)curves.size(); c++)
+    {
+        const Curve &curve = curves[c];
+        bool visible = false;
+        for (const Segment &segment : curve.segments)
+        {
+            visible = visible || !(segment.bounds & region).empty();
+        }
+        if (!visible)
+        {
+            continue;
+        }
+
+        // 控制多边形
+        for (std::size_t i = 1; i < curve.points.size(); i++)
+        {
+            cv::line(roi, local(curve.points[i - 1]), local(curve.points[i]), {80, 80, 80}, 1);
+        }
+        // 曲线：整条折线一起描边（相接处不会重复混合），只写 region 以内的像素
+        rasterizer.stroke(canvas, curve.polyline, kStrokeWidth, cv::Vec3b(0, 255, 0), region);
+        // 控制点，当前曲线的用白色
+        cv::Scalar color = c == active ? cv::Scalar(255, 255, 255) : cv::Scalar(140, 140, 140);
+        for (const cv::Point2f &p : curve.points)
+        {
+            cv::circle(roi, local(p), 3, color, 3);
+        }
+    }
+}
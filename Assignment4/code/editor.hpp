@@ -0,0 +1,72 @@
+#ifndef BEZIER_EDITOR_HPP
+#define BEZIER_EDITOR_HPP
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "stroke.hpp"
+
+// 交互式 Bezier 编辑器：多条曲线，每条曲线任意多个控制点，可以拖动控制点。
+//   左键点空白处：给当前曲线加一个控制点；左键按住控制点：拖动
+//   右键 / n：开始一条新曲线       m：当前曲线在「整条一个 Bezier」和「分段三次」之间切换
+//   x：删掉当前曲线的最后一个控制点   c：清空   s：保存为 my_bezier_curve.png   Esc：退出
+// 每条曲线分成若干段（整条 Bezier 只有一段；分段三次时每段 4 个控制点，相邻段共用端点），
+// 每段缓存展平后的折线和包围盒。移动一个控制点只重新展平包含它的段，
+// 画面上也只重画这些段新旧包围盒的并集（脏矩形），其余像素保持不变
+class CurveEditor
+{
+public:
+    CurveEditor(int width, int height);
+
+    void on_mouse(int event, int x, int y);
+    // 返回 false 表示退出
+    bool on_key(int key);
+
+    // 重新展平脏的段并重画脏矩形，画面有变化时返回 true
+    bool update();
+
+    const cv::Mat &image() const { return canvas; }
+
+    // 上一次 update 重新展平的段数、重画的像素数
+    int last_flattened = 0;
+    int last_redrawn_pixels = 0;
+
+private:
+    struct Segment
+    {
+        int first, count;                 // 控制点下标区间
+        std::vector<cv::Point2f> polyline; // 展平后的折线
+        cv::Rect bounds;                  // 控制点的包围盒（外扩 margin），曲线、控制多边形和控制点标记都在里面
+        bool dirty;
+    };
+
+    struct Curve
+    {
+        std::vector<cv::Point2f> points;
+        bool piecewise = false;
+        std::vector<Segment> segments;
+        std::vector<cv::Point2f> polyline; // 各段折线首尾相接
+        bool polyline_dirty = true;
+    };
+
+    // 点数或分段方式变了：重新划分段，所有段都要重新展平
+    void rebuild_segments(Curve &curve);
+    // 控制点 i 移动了：包含它的段标记为脏，新旧包围盒加入脏矩形
+    void move_point(int c, int i, const cv::Point2f &position);
+    void refresh_bounds(Segment &segment, const Curve &curve);
+    void set_active(int c);
+    void invalidate(const cv::Rect &rect);
+    void redraw(const cv::Rect &region);
+    // 离 p 最近（不超过 radius 像素）的控制点，没有时返回 false
+    bool pick(const cv::Point2f &p, float radius, int &curve, int &point) const;
+
+    std::vector<Curve> curves;
+    int active = 0;
+    int drag_curve = -1, drag_point = -1;
+
+    cv::Mat canvas;
+    cv::Rect dirty_region;
+    StrokeRasterizer rasterizer;
+};
+
+#endif //BEZIER_EDITOR_HPP
@@ -1,12 +1,22 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <random>
+#include <string>
 #include <opencv2/opencv.hpp>
 
+#include "curve.hpp"
+#include "editor.hpp"
+#include "stroke.hpp"
+
 std::vector<cv::Point2f> control_points;
+std::size_t num_control_points = 4; // 点够这么多个以后画曲线（-n 指定）
 
 void mouse_handler(int event, int x, int y, int flags, void *userdata) 
 {
-    if (event == cv::EVENT_LBUTTONDOWN && control_points.size() < 4) 
+    if (event == cv::EVENT_LBUTTONDOWN && control_points.size() < num_control_points) 
     {
         std::cout << "Left button of the mouse is clicked - position (" << x << ", "
         << y << ")" << '\n';
@@ -16,15 +26,17 @@ void mouse_handler(int event, int x, int y, int flags, void *userdata)
 
 void naive_bezier(const std::vector<cv::Point2f> &points, cv::Mat &window) 
 {
-    auto &p_0 = points[0];
-    auto &p_1 = points[1];
-    auto &p_2 = points[2];
-    auto &p_3 = points[3];
-
+    // Bernstein 形式 B(t) = sum C(n-1, i) t^i (1-t)^(n-1-i) P_i，任意个控制点
+    const int n = (int)points.size();
     for (double t = 0.0; t <= 1.0; t += 0.001) 
     {
-        auto point = std::pow(1 - t, 3) * p_0 + 3 * t * std::pow(1 - t, 2) * p_1 +
-                 3 * std::pow(t, 2) * (1 - t) * p_2 + std::pow(t, 3) * p_3;
+        cv::Point2f point(0.0f, 0.0f);
+        double binomial = 1; // C(n-1, i)
+        for (int i = 0; i < n; i++)
+        {
+            point += (float)(binomial * std::pow(t, i) * std::pow(1 - t, n - 1 - i)) * points[i];
+            binomial = binomial * (n - 1 - i) / (i + 1);
+        }
 
         window.at<cv::Vec3b>(point.y, point.x)[2] = 255;
     }
@@ -42,73 +54,135 @@ cv::Point2f recursive_bezier(const std::vector<cv::Point2f> &control_points, flo
     //     point += c * std::pow(t, i) * std::pow(1 - t, n - 1 - i) * control_points[i];
     // }
 
-    // 递归方法
-    if(control_points.size() == 2)
-    {
-        return control_points[0] + t * (control_points[1] - control_points[0]);
-    }
+    // 递归方法：每一层都新建一个 vector，改为在临时数组里原地逐层插值（见 curve.cpp）
+    return de_casteljau(control_points, t);
+}
 
-    std::vector<cv::Point2f> vec;
-    for (int i = 0; i < control_points.size() - 1; i++)
+void bezier(const std::vector<cv::Point2f> &control_points, cv::Mat &window) 
+{
+    // 不再逐点采样再向周围像素摊开亮度（同一个像素被写很多次、锯齿明显）：
+    // 先自适应展平成误差不超过 0.2 像素的折线，再按像素到折线的距离解析地计算覆盖率，每个像素只写一次
+    static StrokeRasterizer rasterizer;
+    std::vector<cv::Point2f> polyline;
+    flatten_bezier(control_points, 0.2f, polyline);
+    rasterizer.stroke(window, polyline, 1.5f, cv::Vec3b(0, 255, 0));
+}
+
+// 编辑器模式：见 editor.hpp 里的操作说明
+int run_editor()
+{
+    CurveEditor editor(700, 700);
+    cv::namedWindow("Bezier Curve", cv::WINDOW_AUTOSIZE);
+    cv::setMouseCallback("Bezier Curve", [](int event, int x, int y, int flags, void *userdata) {
+        static_cast<CurveEditor *>(userdata)->on_mouse(event, x, y);
+    }, &editor);
+    cv::imshow("Bezier Curve", editor.image());
+
+    while (true)
     {
-        vec.push_back(control_points[i] + t * (control_points[i + 1] - control_points[i]));
+        // 只有控制点变化时才重新展平、重画脏矩形
+        if (editor.update())
+        {
+            cv::imshow("Bezier Curve", editor.image());
+        }
+        int key = cv::waitKey(15);
+        if (key >= 0 && !editor.on_key(key))
+        {
+            break;
+        }
     }
-
-    return recursive_bezier(vec, t);
+    return 0;
 }
 
-void bezier(const std::vector<cv::Point2f> &control_points, cv::Mat &window) 
+// 基准模式：随机生成一批三次曲线，比较逐点 de Casteljau、单条曲线批量 Horner、
+// 多条曲线一起批量 Horner 的耗时，以及两种 Horner 相对 de Casteljau 的最大误差
+int run_benchmark()
 {
-    // TODO: Iterate through all t = 0 to t = 1 with small steps, and call de Casteljau's 
-    // recursive Bezier algorithm.
+    const int num_curves = 1024, num_points = 4;
+    std::vector<std::vector<cv::Point2f>> curves(num_curves);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> coord(0.0f, 700.0f);
+    for (auto &curve : curves)
+    {
+        for (int i = 0; i < num_points; i++)
+        {
+            curve.emplace_back(coord(rng), coord(rng));
+        }
+    }
+    std::vector<float> ts;
+    uniform_parameters(256, ts);
+    const std::size_t count = ts.size(), total = count * num_curves;
+
+    auto seconds = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto max_error = [&](const std::vector<cv::Point2f> &reference, const std::vector<float> &x,
+                         const std::vector<float> &y, bool curve_major) {
+        float error = 0;
+        for (int c = 0; c < num_curves; c++)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                std::size_t k = curve_major ? c * count + i : i * num_curves + c;
+                cv::Point2f d = reference[c * count + i] - cv::Point2f(x[k], y[k]);
+                error = std::max(error, std::sqrt(d.dot(d)));
+            }
+        }
+        return error;
+    };
 
-        // TODO: Iterate through all t = 0 to t = 1 with small steps, and call de Casteljau's 
-    // recursive Bezier algorithm. 递归贝塞尔曲线实现算法
-    for (double t = 0.0; t <= 1.0; t += 0.0001)
+    auto start = std::chrono::steady_clock::now();
+    std::vector<cv::Point2f> reference(total);
+    for (int c = 0; c < num_curves; c++)
     {
-        cv::Point2f point = recursive_bezier(control_points, t);
-        window.at<cv::Vec3b>(point.y, point.x)[1] = 255;
-
-        //anti-aliasing
-        float x = point.x - std::floor(point.x);
-        float y = point.y - std::floor(point.y);
-        int x_flag = x < 0.5f ? -1 : 1;
-        int y_flag = y < 0.5f ? -1 : 1;
-
-        // 距离采样点最近的4个坐标点
-        cv::Point2f p00 = cv::Point2f(std::floor(point.x) + 0.5f, std::floor(point.y) + 0.5f);
-        cv::Point2f p01 = cv::Point2f(std::floor(point.x + x_flag * 1.0f) + 0.5f, std::floor(point.y) + 0.5f);
-        cv::Point2f p10 = cv::Point2f(std::floor(point.x) + 0.5f, std::floor(point.y + y_flag * 1.0f) + 0.5f);
-        cv::Point2f p11 = cv::Point2f(std::floor(point.x + x_flag * 1.0f) + 0.5f, std::floor(point.y + y_flag * 1.0f) + 0.5f);
-
-        std::vector<cv::Point2f> vec;
-        vec.push_back(p01);
-        vec.push_back(p10);
-        vec.push_back(p11);
-
-        // 计算最近的坐标点与采样点距离
-        cv::Point2f distance = p00 - point;
-        float len = sqrt(distance.x * distance.x + distance.y * distance.y);
-
-        // 对边缘点进行着色
-        for(auto p:vec)
+        for (std::size_t i = 0; i < count; i++)
         {
-            // 根据距离比, 计算边缘点影响系数
-            cv::Point2f d = p - point;
-            float l = sqrt(d.x * d.x + d.y * d.y);
-            float percnet = len / l;
-
-            cv::Vec3d color = window.at<cv::Vec3b>(p.y, p.x);
-            // 此处简单粗暴取最大值
-            color[1] = std::max(color[1], (double)255 * percnet);
-            window.at<cv::Vec3b>(p.y, p.x) = color;
+            reference[c * count + i] = recursive_bezier(curves[c], ts[i]);
         }
     }
+    double casteljau_time = seconds(start);
 
+    start = std::chrono::steady_clock::now();
+    std::vector<float> xs(total), ys(total);
+    for (int c = 0; c < num_curves; c++)
+    {
+        PowerBasis(curves[c]).evaluate(ts.data(), count, &xs[c * count], &ys[c * count]);
+    }
+    double single_time = seconds(start);
+    float single_error = max_error(reference, xs, ys, true);
+
+    start = std::chrono::steady_clock::now();
+    PowerBasisBatch(curves).evaluate(ts.data(), count, xs.data(), ys.data());
+    double batch_time = seconds(start);
+    float batch_error = max_error(reference, xs, ys, false);
+
+    std::cout << num_curves << " cubics x " << count << " parameters\n"
+              << "  de Casteljau:         " << casteljau_time * 1e3 << " ms\n"
+              << "  Horner per curve:     " << single_time * 1e3 << " ms, max error " << single_error << " px\n"
+              << "  Horner across curves: " << batch_time * 1e3 << " ms, max error " << batch_error << " px\n";
+    return 0;
 }
 
-int main() 
+int main(int argc, char **argv) 
 {
+    // -e：交互式编辑器；-b：曲线求值基准；-n <INT>：点满多少个控制点后画曲线（默认 4）
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-e")
+        {
+            return run_editor();
+        }
+        if (arg == "-b")
+        {
+            return run_benchmark();
+        }
+        if (arg == "-n" && i + 1 < argc)
+        {
+            num_control_points = std::max(2, std::atoi(argv[++i]));
+        }
+    }
+
     cv::Mat window = cv::Mat(700, 700, CV_8UC3, cv::Scalar(0));
     cv::cvtColor(window, window, cv::COLOR_BGR2RGB);
     cv::namedWindow("Bezier Curve", cv::WINDOW_AUTOSIZE);
@@ -123,10 +197,10 @@ int main()
             cv::circle(window, point, 3, {255, 255, 255}, 3);
         }
 
-        if (control_points.size() == 4) 
+        if (control_points.size() == num_control_points) 
         {
             naive_bezier(control_points, window);
-            // bezier(control_points, window);
+            bezier(control_points, window);
 
             cv::imshow("Bezier Curve", window);
             cv::imwrite("my_bezier_curve.png", window);
@@ -0,0 +1,83 @@
+#include "stroke.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// 一维盒式滤波下，宽 2r、中心距离像素中心 d 的带子覆盖像素的比例
+static float band_coverage(float d, float r)
+{
+    float outer = std::min(std::max(r + 0.5f - d, 0.0f), 1.0f);
+    float inner = std::min(std::max(0.5f - r - d, 0.0f), 1.0f);
+    return outer - inner;
+}
+
+void StrokeRasterizer::stroke(cv::Mat &window, const std::vector<cv::Point2f> &polyline, float width,
+                              const cv::Vec3b &color)
+{
+    stroke(window, polyline, width, color, cv::Rect(0, 0, window.cols, window.rows));
+}
+
+void StrokeRasterizer::stroke(cv::Mat &window, const std::vector<cv::Point2f> &polyline, float width,
+                              const cv::Vec3b &color, const cv::Rect &clip)
+{
+    const cv::Rect area = clip & cv::Rect(0, 0, window.cols, window.rows);
+    if (polyline.empty() || area.empty())
+    {
+        return;
+    }
+    const int cols = window.cols, rows = window.rows;
+    coverage.resize((std::size_t)cols * rows, 0.0f);
+    touched.clear();
+
+    const float r = 0.5f * width;
+    const float reach = r + 0.5f; // 超过这个距离覆盖率为 0
+    // 只有一个点时当作长度为 0 的线段，画成圆点
+    const std::size_t segments = std::max<std::size_t>(polyline.size() - 1, 1);
+    for (std::size_t s = 0; s < segments; s++)
+    {
+        const cv::Point2f a = polyline[s];
+        const cv::Point2f b = polyline[std::min(s + 1, polyline.size() - 1)];
+        const cv::Point2f ab = b - a;
+        const float len2 = ab.dot(ab);
+        const float inv_len2 = len2 > 0 ? 1.0f / len2 : 0.0f;
+
+        // 线段包围盒外扩 reach，裁剪到 area
+        const int x0 = std::max(area.x, (int)std::floor(std::min(a.x, b.x) - reach));
+        const int x1 = std::min(area.x + area.width - 1, (int)std::ceil(std::max(a.x, b.x) + reach));
+        const int y0 = std::max(area.y, (int)std::floor(std::min(a.y, b.y) - reach));
+        const int y1 = std::min(area.y + area.height - 1, (int)std::ceil(std::max(a.y, b.y) + reach));
+        for (int y = y0; y <= y1; y++)
+        {
+            float *row = &coverage[(std::size_t)y * cols];
+            for (int x = x0; x <= x1; x++)
+            {
+                // 像素 (x, y) 的中心在 (x + 0.5, y + 0.5)
+                cv::Point2f ap = cv::Point2f(x + 0.5f, y + 0.5f) - a;
+                float t = std::min(std::max(ap.dot(ab) * inv_len2, 0.0f), 1.0f);
+                cv::Point2f d = ap - t * ab;
+                float c = band_coverage(std::sqrt(d.dot(d)), r);
+                if (c > row[x])
+                {
+                    if (row[x] == 0.0f)
+                    {
+                        touched.push_back(y * cols + x);
+                    }
+                    row[x] = c;
+                }
+            }
+        }
+    }
+
+    // 每个像素混合一次，顺便把覆盖率缓冲清零留给下一次
+    for (int index : touched)
+    {
+        const int y = index / cols, x = index - y * cols;
+        const float alpha = coverage[index];
+        cv::Vec3b &pixel = window.at<cv::Vec3b>(y, x);
+        for (int k = 0; k < 3; k++)
+        {
+            pixel[k] = (unsigned char)std::lround(pixel[k] + alpha * (color[k] - pixel[k]));
+        }
+        coverage[index] = 0.0f;
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef BEZIER_STROKE_HPP
+#define BEZIER_STROKE_HPP
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// 折线描边的光栅化，带解析的抗锯齿：
+// 像素的覆盖率由像素中心到折线的距离 d 算出，宽为 width 的笔画在一个像素宽的盒式滤波下覆盖
+//   clamp(r + 0.5 - d, 0, 1) - clamp(0.5 - r - d, 0, 1)，r = width / 2。
+// 折线上各段的覆盖率取最大值（等价于到整条折线的最短距离），全部算完以后每个像素只混合写入一次
+class StrokeRasterizer
+{
+public:
+    // 把 polyline 以 width 像素宽、color 颜色混合到 window（CV_8UC3）上
+    void stroke(cv::Mat &window, const std::vector<cv::Point2f> &polyline, float width,
+                const cv::Vec3b &color);
+    // 同上，只写 clip 以内的像素（局部重画时用）
+    void stroke(cv::Mat &window, const std::vector<cv::Point2f> &polyline, float width,
+                const cv::Vec3b &color, const cv::Rect &clip);
+
+private:
+    // 与窗口同样大小的覆盖率缓冲（跨调用复用，写完后只清掉用到的像素）和本次碰到的像素下标
+    std::vector<float> coverage;
+    std::vector<int> touched;
+};
+
+#endif //BEZIER_STROKE_HPP
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "Vector.hpp"
+#include "Object.hpp"
+
+//轴对齐包围盒
+struct Bounds3
+{
+    Vector3f pMin = Vector3f(kInfinity);
+    Vector3f pMax = Vector3f(-kInfinity);
+
+    void expand(const Vector3f& p)
+    {
+        pMin = Vector3f(std::min(pMin.x, p.x), std::min(pMin.y, p.y), std::min(pMin.z, p.z));
+        pMax = Vector3f(std::max(pMax.x, p.x), std::max(pMax.y, p.y), std::max(pMax.z, p.z));
+    }
+    void expand(const Bounds3& b)
+    {
+        expand(b.pMin);
+        expand(b.pMax);
+    }
+
+    Vector3f centroid() const { return (pMin + pMax) * 0.5f; }
+
+    //跨度最大的轴：0=x, 1=y, 2=z
+    int maxExtent() const
+    {
+        Vector3f d = pMax - pMin;
+        if (d.x > d.y && d.x > d.z)
+            return 0;
+        return d.y > d.z ? 1 : 2;
+    }
+
+    //光线与包围盒求交（slab 方法），只接受 [0, tMax] 之间的交点
+    //invDir：光线方向的倒数，每条光线只算一次
+    bool intersectP(const Vector3f& orig, const Vector3f& invDir, float tMax) const
+    {
+        float tx0 = (pMin.x - orig.x) * invDir.x, tx1 = (pMax.x - orig.x) * invDir.x;
+        float ty0 = (pMin.y - orig.y) * invDir.y, ty1 = (pMax.y - orig.y) * invDir.y;
+        float tz0 = (pMin.z - orig.z) * invDir.z, tz1 = (pMax.z - orig.z) * invDir.z;
+        float tEnter = std::max({std::min(tx0, tx1), std::min(ty0, ty1), std::min(tz0, tz1), 0.f});
+        float tExit = std::min({std::max(tx0, tx1), std::max(ty0, ty1), std::max(tz0, tz1), tMax});
+        return tEnter <= tExit;
+    }
+};
+
+inline float axisValue(const Vector3f& v, int axis)
+{
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// 场景 BVH：叶子是单个图元（一个球体，或者网格中的一个三角形），
+// 物体之间和网格内部的三角形共用一棵树，求交代价随图元数对数增长
+class BVH
+{
+public:
+    void build(const std::vector<std::unique_ptr<Object> >& objects)
+    {
+        primitives.clear();
+        nodes.clear();
+        for (const auto& object : objects)
+        {
+            for (uint32_t k = 0; k < object->getPrimitiveCount(); ++k)
+            {
+                Primitive prim;
+                prim.object = object.get();
+                prim.index = k;
+                object->getPrimitiveBounds(k, prim.bounds.pMin, prim.bounds.pMax);
+                prim.centroid = prim.bounds.centroid();
+                primitives.push_back(prim);
+            }
+        }
+        if (!primitives.empty())
+        {
+            nodes.reserve(2 * primitives.size());
+            buildRecursive(0, primitives.size());
+        }
+    }
+
+    //返回最近的交点，tNear / index / uv / hitObject 的含义与 Object::intersect 相同
+    bool intersect(const Vector3f& orig, const Vector3f& dir, float& tNear, uint32_t& index, Vector2f& uv,
+                   Object** hitObject) const
+    {
+        *hitObject = nullptr;
+        if (nodes.empty())
+            return false;
+
+        Vector3f invDir(1.f / dir.x, 1.f / dir.y, 1.f / dir.z);
+        bool dirIsNeg[3] = {invDir.x < 0, invDir.y < 0, invDir.z < 0};
+
+        uint32_t stack[64];
+        int sp = 0;
+        stack[sp++] = 0;
+        while (sp > 0)
+        {
+            const Node& node = nodes[stack[--sp]];
+            if (!node.bounds.intersectP(orig, invDir, tNear))
+                continue;
+
+            if (node.count > 0)
+            {//叶子：逐个图元求交，保留最近的
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                {
+                    const Primitive& prim = primitives[i];
+                    float t = kInfinity;
+                    Vector2f uvK;
+                    if (prim.object->intersectPrimitive(prim.index, orig, dir, t, uvK) && t < tNear)
+                    {
+                        tNear = t;
+                        index = prim.index;
+                        uv = uvK;
+                        *hitObject = prim.object;
+                    }
+                }
+                continue;
+            }
+
+            //左孩子紧跟在父节点后面，offset 为右孩子；沿划分轴更近的孩子后入栈、先访问
+            uint32_t left = &node - nodes.data() + 1;
+            if (dirIsNeg[node.axis])
+            {
+                stack[sp++] = left;
+                stack[sp++] = node.offset;
+            }
+            else
+            {
+                stack[sp++] = node.offset;
+                stack[sp++] = left;
+            }
+        }
+        return *hitObject != nullptr;
+    }
+
+private:
+    struct Primitive
+    {
+        Object* object;
+        uint32_t index;//网格中第几个三角形，球体为 0
+        Bounds3 bounds;
+        Vector3f centroid;
+    };
+
+    //扁平存储的节点，深度优先排列
+    struct Node
+    {
+        Bounds3 bounds;
+        uint32_t offset;//叶子：第一个图元的下标；内部节点：右孩子的下标
+        uint32_t count;//叶子中的图元个数，0 表示内部节点
+        int axis;//内部节点的划分轴
+    };
+
+    static constexpr uint32_t kMaxPrimsInLeaf = 4;
+
+    //按质心跨度最大的轴在中位数处划分
+    uint32_t buildRecursive(uint32_t start, uint32_t end)
+    {
+        uint32_t nodeIndex = nodes.size();
+        nodes.emplace_back();
+
+        Bounds3 bounds, centroidBounds;
+        for (uint32_t i = start; i < end; ++i)
+        {
+            bounds.expand(primitives[i].bounds);
+            centroidBounds.expand(primitives[i].centroid);
+        }
+        nodes[nodeIndex].bounds = bounds;
+
+        if (end - start <= kMaxPrimsInLeaf)
+        {
+            nodes[nodeIndex].offset = start;
+            nodes[nodeIndex].count = end - start;
+            return nodeIndex;
+        }
+
+        int axis = centroidBounds.maxExtent();
+        uint32_t mid = (start + end) / 2;
+        std::nth_element(primitives.begin() + start, primitives.begin() + mid, primitives.begin() + end,
+                         [axis](const Primitive& a, const Primitive& b) {
+                             return axisValue(a.centroid, axis) < axisValue(b.centroid, axis);
+                         });
+
+        buildRecursive(start, mid);
+        uint32_t right = buildRecursive(mid, end);
+        //递归过程中 nodes 可能扩容，重新取引用
+        nodes[nodeIndex].offset = right;
+        nodes[nodeIndex].count = 0;
+        nodes[nodeIndex].axis = axis;
+        return nodeIndex;
+    }
+
+    std::vector<Primitive> primitives;
+    std::vector<Node> nodes;
+};
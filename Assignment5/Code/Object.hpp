@@ -20,6 +20,19 @@ public:
     //光线 与 物体求交点
     virtual bool intersect(const Vector3f&, const Vector3f&, float&, uint32_t&, Vector2f&) const = 0;
 
+    //图元数量（BVH 的叶子是单个图元）：球体为 1，网格为三角形个数
+    virtual uint32_t getPrimitiveCount() const
+    {
+        return 1;
+    }
+
+    //第 index 个图元的包围盒
+    virtual void getPrimitiveBounds(const uint32_t& index, Vector3f& pMin, Vector3f& pMax) const = 0;
+
+    //光线 与 第 index 个图元求交，tnear 返回交点时间，uv 返回重心坐标
+    virtual bool intersectPrimitive(const uint32_t& index, const Vector3f& orig, const Vector3f& dir, float& tnear,
+                                    Vector2f& uv) const = 0;
+
     //
     virtual void getSurfaceProperties(const Vector3f&, const Vector3f&, const uint32_t&, const Vector2f&, Vector3f&,
                                       Vector2f&) const = 0;
@@ -3,6 +3,11 @@
 #include "Renderer.hpp"
 #include "Scene.hpp"
 #include <optional>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <random>
 
 //弧度
 inline float deg2rad(const float &deg)
@@ -118,40 +123,33 @@ float fresnel(const Vector3f &I, const Vector3f &N, const float &ior)
 //
 // \param orig is the ray origin
 // \param dir is the ray direction
-// \param objects is the list of objects the scene contains
+// \param scene is the scene, whose BVH is used to find the closest primitive
 //
 // \param[out] tNear contains the distance to the cloesest intersected object.
 // \param[out] index stores the index of the intersect triangle if the interesected object is a mesh.
 // \param[out] uv stores the u and v barycentric coordinates of the intersected point
 // \param[out] *hitObject stores the pointer to the intersected object (used to retrieve material information, etc.)
-// \param isShadowRay is it a shadow ray. We can return from the function sooner as soon as we have found a hit.
 // [/comment]
 // 光线追踪，如果有光线，返回 pyload，没有返回 false
-// 注意：这里仅为一条光线
+// 注意：这里仅为一条光线，求交通过场景的 BVH 完成，不再遍历所有物体和所有三角形
 std::optional<hit_payload> trace(
         const Vector3f &orig, const Vector3f &dir,
-        const std::vector<std::unique_ptr<Object> > &objects)
+        const Scene& scene)
 {
     float tNear = kInfinity;
+    uint32_t index = 0;
+    Vector2f uv;
+    Object* hitObject = nullptr;
     std::optional<hit_payload> payload;
-    for (const auto & object : objects)
+    if (scene.get_bvh().intersect(orig, dir, tNear, index, uv, &hitObject))
     {
-        float tNearK = kInfinity;
-        uint32_t indexK;
-        Vector2f uvK;
-        // 相交  且  更近
-        if (object->intersect(orig, dir, tNearK, indexK, uvK) && tNearK < tNear)
-        {
-            payload.emplace();
-            payload->hit_obj = object.get();//相交的对象
-            payload->tNear = tNearK;//最近的 相交对象的 相交面的 距离
-            payload->index = indexK;//光线 与 mesh 相交 triangle 的 index
-            payload->uv = uvK;//重心坐标
-            tNear = tNearK;
-        }
+        payload.emplace();
+        payload->hit_obj = hitObject;//相交的对象
+        payload->tNear = tNear;//最近的 相交对象的 相交面的 距离
+        payload->index = index;//光线 与 mesh 相交 triangle 的 index
+        payload->uv = uv;//重心坐标
     }
 
-    // 最终返回的只有一个相交的 obj
     return payload;
 }
 
@@ -175,7 +173,48 @@ std::optional<hit_payload> trace(
 Vector3f castRay(const Vector3f &orig, 
                  const Vector3f &dir, 
                  const Scene& scene,
-                 int depth)
+                 int depth,
+                 float weight,
+                 RayStats& stats);
+
+// 随机剪枝用的 [0, 1) 随机数：每个工作线程一个随机数引擎，第一次用到时播种一次
+static float roulette_random()
+{
+    thread_local std::mt19937 rng(std::random_device{}());
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    return dist(rng);
+}
+
+// 追踪一条反射/折射子光线，weight 为它对像素颜色的累计权重
+// 权重低于 scene.minRayWeight 时剪掉该分支（返回黑色），或者在随机剪枝模式下按概率继续
+Vector3f castBranch(const Vector3f &orig,
+                    const Vector3f &dir,
+                    const Scene& scene,
+                    int depth,
+                    float weight,
+                    RayStats& stats)
+{
+    if (weight < scene.minRayWeight)
+    {
+        float survive = weight / scene.minRayWeight;
+        if (!scene.stochasticPruning || roulette_random() >= survive)
+        {
+            stats.raysPruned++;
+            return Vector3f(0.0, 0.0, 0.0);
+        }
+        //幸存的分支按 1/survive 放大，期望值与不剪枝时相同
+        stats.raysSurvived++;
+        return castRay(orig, dir, scene, depth + 1, scene.minRayWeight, stats) * (1 / survive);
+    }
+    return castRay(orig, dir, scene, depth + 1, weight, stats);
+}
+
+Vector3f castRay(const Vector3f &orig, 
+                 const Vector3f &dir, 
+                 const Scene& scene,
+                 int depth,
+                 float weight,
+                 RayStats& stats)
 {
     /**
      * @brief whitted-style 的递归光线追踪方式
@@ -183,6 +222,8 @@ Vector3f castRay(const Vector3f &orig,
      * dir：光线的传播方向
      * sence：场景（包括场景中的物体）
      * depth：递归深度
+     * weight：这条光线对像素颜色的累计权重（主光线为 1，每次反射/折射乘上 kr 或 1-kr）
+     * stats：光线统计（本线程）
      */
 
     //超过递归深度直接返回0，（递归返回条件）
@@ -192,6 +233,7 @@ Vector3f castRay(const Vector3f &orig,
     if (depth > scene.maxDepth) {
         return Vector3f(0.0,0.0,0.0);
     }
+    stats.raysTraced++;
 
     //初始化背景色
     //注意：球体中的背景色既不是折射来的，也不是反射来的
@@ -200,7 +242,7 @@ Vector3f castRay(const Vector3f &orig,
     // Vector3f hitColor = Vector3f(0.0, 0.0, 0.0);//去掉背景色
 
     //如果这条光线与物体相交并返回payload
-    if (auto payload = trace(orig, dir, scene.get_objects()); payload)
+    if (auto payload = trace(orig, dir, scene); payload)
     {
         //通过光线的起点、方向、时间、算出击中的点
         Vector3f hitPoint = orig + dir * payload->tNear;//击中点
@@ -228,11 +270,12 @@ Vector3f castRay(const Vector3f &orig,
                 Vector3f refractionRayOrig = (dotProduct(refractionDirection, N) < 0) ?
                                              hitPoint - N * scene.epsilon :
                                              hitPoint + N * scene.epsilon;
-                //递归调用 castRay，并返回 color
-                Vector3f reflectionColor = castRay(reflectionRayOrig, reflectionDirection, scene, depth + 1);
-                Vector3f refractionColor = castRay(refractionRayOrig, refractionDirection, scene, depth + 1);
-
                 float kr = fresnel(dir, N, payload->hit_obj->ior);//菲尼耳方程计算反射能量占比
+
+                //递归调用 castRay，并返回 color；权重过低的一支直接剪掉
+                Vector3f reflectionColor = castBranch(reflectionRayOrig, reflectionDirection, scene, depth, weight * kr, stats);
+                Vector3f refractionColor = castBranch(refractionRayOrig, refractionDirection, scene, depth, weight * (1 - kr), stats);
+
                 hitColor = reflectionColor * kr + refractionColor * (1 - kr);//当前以及更深 深度的 颜色和
                 break;
             }
@@ -245,7 +288,7 @@ Vector3f castRay(const Vector3f &orig,
                                              hitPoint + N * scene.epsilon :
                                              hitPoint - N * scene.epsilon;
                 
-                hitColor = castRay(reflectionRayOrig, reflectionDirection, scene, depth + 1) * kr;
+                hitColor = castBranch(reflectionRayOrig, reflectionDirection, scene, depth, weight * kr, stats) * kr;
                 break;
             }
             default:
@@ -279,7 +322,7 @@ Vector3f castRay(const Vector3f &orig,
                     
                     // is the point in shadow, and is the nearest occluding object closer to the object than the light itself?
                     // 光
-                    auto shadow_res = trace(shadowPointOrig, lightDir, scene.get_objects());
+                    auto shadow_res = trace(shadowPointOrig, lightDir, scene);
 
                     // 是不是阴影
                     bool inShadow = shadow_res && (shadow_res->tNear * shadow_res->tNear < lightDistance2);
@@ -317,7 +360,7 @@ Vector3f castRay(const Vector3f &orig,
 // saved to a file.
 // [/comment]
 // 主要的 着色 函数
-void Renderer::Render(const Scene& scene)
+RayStats Renderer::Render(const Scene& scene)
 {
     // 帧缓存
     std::vector<Vector3f> framebuffer(scene.width * scene.height);
@@ -327,46 +370,89 @@ void Renderer::Render(const Scene& scene)
     float imageAspectRatio = scene.width / (float)scene.height;
 
     // Use this variable as the eye position to start your rays.
-    //眼睛设置为世界坐标的 (0,0,0)位置, 屏幕是 z轴方向 值为-1 的平面上
-    Vector3f eye_pos(0);
-
-    int m = 0;
-    for (int j = 0; j < scene.height; ++j)
+    //眼睛默认在世界坐标的 (0,0,0)位置（可由场景文件修改）, 屏幕是眼睛前方 z轴方向 -1 处的平面
+    Vector3f eye_pos = scene.eye_pos;
+
+    // 画面按 kTileSize x kTileSize 切成 tile，工作线程从原子计数器依次领取 tile，
+    // 每个像素只写自己的 framebuffer 位置，线程之间不需要加锁
+    constexpr int kTileSize = 32;
+    int tilesX = (scene.width + kTileSize - 1) / kTileSize;
+    int tilesY = (scene.height + kTileSize - 1) / kTileSize;
+    int numTiles = tilesX * tilesY;
+    std::atomic<int> nextTile{0};
+    std::atomic<int> tilesDone{0};
+    std::mutex progressMutex;
+
+    RayStats stats;
+
+    auto renderTiles = [&]()
     {
-        for (int i = 0; i < scene.width; ++i)
+        RayStats localStats;
+        for (int tile = nextTile++; tile < numTiles; tile = nextTile++)
         {
-            // generate primary ray direction
-            // 分别对应每一个像素
-            float x;
-            float y;
-            // TODO: Find the x and y positions of the current pixel to get the direction
-            // 找到当前 x 和 y 的像素位置 给 感受射线用
-            // vector that passes through it.
-            // Also, don't forget to multiply both of them with the variable *scale*, and
-            // x (horizontal) variable with the *imageAspectRatio*            
-
-            //像素映射,因为眼睛之在中间,而不是左上角
-            //把 0 - width 映射到 -1 ---- 1 之间， 再 * scale
-            x = (((i + 0.5) / ((float)scene.width) * 2)-1);
-            x = x * imageAspectRatio * scale;
-            //把 0 - height 映射到 1 ---- -1 之间， 再 * scale
-            y = (1 - (j + 0.5) / (float)scene.height * 2 );
-            y = y * scale;
-
-            //感受光线
-            // z轴-1平面上，每个感受光线的向量，需要作归一化 normalize
-            Vector3f dir = Vector3f(x, y, -1); // Don't forget to normalize this direction!
-
-            //对每个像素的感受光线进行光线追踪,返回结果进行着色
-            framebuffer[m++] = castRay(eye_pos, dir, scene, 0);
+            int x0 = (tile % tilesX) * kTileSize;
+            int y0 = (tile / tilesX) * kTileSize;
+            int x1 = std::min(x0 + kTileSize, scene.width);
+            int y1 = std::min(y0 + kTileSize, scene.height);
+            for (int j = y0; j < y1; ++j)
+            {
+                for (int i = x0; i < x1; ++i)
+                {
+                    // generate primary ray direction
+                    // 分别对应每一个像素
+                    float x;
+                    float y;
+                    // TODO: Find the x and y positions of the current pixel to get the direction
+                    // 找到当前 x 和 y 的像素位置 给 感受射线用
+                    // vector that passes through it.
+                    // Also, don't forget to multiply both of them with the variable *scale*, and
+                    // x (horizontal) variable with the *imageAspectRatio*
+
+                    //像素映射,因为眼睛之在中间,而不是左上角
+                    //把 0 - width 映射到 -1 ---- 1 之间， 再 * scale
+                    x = (((i + 0.5) / ((float)scene.width) * 2)-1);
+                    x = x * imageAspectRatio * scale;
+                    //把 0 - height 映射到 1 ---- -1 之间， 再 * scale
+                    y = (1 - (j + 0.5) / (float)scene.height * 2 );
+                    y = y * scale;
+
+                    //感受光线
+                    // z轴-1平面上，每个感受光线的向量，需要作归一化 normalize
+                    Vector3f dir = Vector3f(x, y, -1); // Don't forget to normalize this direction!
+
+                    //对每个像素的感受光线进行光线追踪,返回结果进行着色
+                    framebuffer[j * scene.width + i] = castRay(eye_pos, dir, scene, 0, 1.0f, localStats);
+                }
+            }
+
+            //着色进度条
+            int done = ++tilesDone;
+            std::lock_guard<std::mutex> lock(progressMutex);
+            UpdateProgress(done / (float)numTiles);
         }
 
-        //着色进度条
-        UpdateProgress(j / (float)scene.height);
-    }
+        std::lock_guard<std::mutex> lock(progressMutex);
+        stats += localStats;
+    };
+
+    unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < numThreads; ++t)
+        workers.emplace_back(renderTiles);
+    for (auto& worker : workers)
+        worker.join();
+
+    std::cout << "\nRays traced: " << stats.raysTraced
+              << ", pruned: " << stats.raysPruned
+              << ", survived roulette: " << stats.raysSurvived << std::endl;
 
     // save framebuffer to file
-    FILE* fp = fopen("binary.ppm", "wb");
+    FILE* fp = fopen(scene.output.c_str(), "wb");
+    if (!fp)
+    {
+        std::cerr << "Cannot open " << scene.output << " for writing\n";
+        return stats;
+    }
     (void)fprintf(fp, "P6\n%d %d\n255\n", scene.width, scene.height);
     
     for (auto i = 0; i < scene.height * scene.width; ++i) {
@@ -377,4 +463,5 @@ void Renderer::Render(const Scene& scene)
         fwrite(color, 1, 3, fp);
     }
     fclose(fp);    
+    return stats;
 }
@@ -9,10 +9,27 @@ struct hit_payload
     Object* hit_obj;//击中的对象
 };
 
+//光线树统计：每个渲染线程先在本地累加，渲染结束后合并，作为 Render 的返回值
+struct RayStats
+{
+    uint64_t raysTraced = 0;//实际追踪的光线（主光线 + 反射/折射光线）
+    uint64_t raysPruned = 0;//累计权重低于阈值、被剪掉（省下）的反射/折射光线
+    uint64_t raysSurvived = 0;//随机剪枝时低权重但幸存下来继续追踪的光线
+
+    RayStats& operator+=(const RayStats& other)
+    {
+        raysTraced += other.raysTraced;
+        raysPruned += other.raysPruned;
+        raysSurvived += other.raysSurvived;
+        return *this;
+    }
+};
+
 class Renderer
 {
 public:
-    void Render(const Scene& scene);
+    //渲染并写出图像，返回本次渲染的光线统计
+    RayStats Render(const Scene& scene);
 
 private:
 };
\ No newline at end of file
@@ -2,9 +2,11 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 #include "Vector.hpp"
 #include "Object.hpp"
 #include "Light.hpp"
+#include "BVH.hpp"
 
 class Scene
 {
@@ -17,6 +19,12 @@ public:
     Vector3f backgroundColor = Vector3f(0.1, 0.1, 0.0);
     int maxDepth = 10;//光线递归深度
     float epsilon = 0.00001;//一个很小的数，用于边缘位移,如果没有它,表面就会有很多模棱两可的值
+    //光线树剪枝：每条光线带着从主光线累乘下来的菲涅耳权重，低于 minRayWeight 的分支不再追踪（0 表示不剪枝）
+    float minRayWeight = 0.01f;
+    //true：低权重分支以 weight / minRayWeight 的概率继续追踪（俄罗斯轮盘赌），结果按概率放大，保持无偏
+    bool stochasticPruning = false;
+    Vector3f eye_pos = Vector3f(0);//视点位置，屏幕在它前方 z=-1 处
+    std::string output = "binary.ppm";//输出文件
 
     Scene(int w, int h) : width(w), height(h)
     {}
@@ -29,8 +37,13 @@ public:
     [[nodiscard]] const std::vector<std::unique_ptr<Object> >& get_objects() const { return objects; }
     [[nodiscard]] const std::vector<std::unique_ptr<Light> >&  get_lights() const { return lights; }
 
+    //物体添加完之后构建 BVH，渲染时的求交都走 BVH
+    void buildBVH() { bvh.build(objects); }
+    [[nodiscard]] const BVH& get_bvh() const { return bvh; }
+
 private:
     // creating the scene (adding objects and lights)
     std::vector<std::unique_ptr<Object> > objects;
     std::vector<std::unique_ptr<Light> > lights;
+    BVH bvh;
 };
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include <array>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include "SceneFile.hpp"
+#include "Sphere.hpp"
+#include "Triangle.hpp"
+
+namespace
+{
+
+std::string directoryOf(const std::string& path)
+{
+    auto pos = path.find_last_of('/');
+    return pos == std::string::npos ? std::string() : path.substr(0, pos + 1);
+}
+
+std::string resolvePath(const std::string& base, const std::string& path)
+{
+    if (path.empty() || path[0] == '/')
+        return path;
+    return directoryOf(base) + path;
+}
+
+//逐行读取场景文件，记录行号，出错时给出位置
+struct LineReader
+{
+    std::string filename;
+    int lineNumber = 0;
+
+    [[noreturn]] void fail(const std::string& message) const
+    {
+        throw std::runtime_error(filename + ":" + std::to_string(lineNumber) + ": " + message);
+    }
+
+    float toFloat(const std::string& s) const
+    {
+        try
+        {
+            size_t used = 0;
+            float v = std::stof(s, &used);
+            if (used == s.size())
+                return v;
+        }
+        catch (const std::exception&) {}
+        fail("expected a number, got '" + s + "'");
+    }
+
+    int toInt(const std::string& s) const
+    {
+        float v = toFloat(s);
+        if (v != (int)v)
+            fail("expected an integer, got '" + s + "'");
+        return (int)v;
+    }
+
+    //"r,g,b" 或单个数字
+    Vector3f toVector(const std::string& s) const
+    {
+        std::vector<std::string> parts;
+        std::stringstream ss(s);
+        std::string part;
+        while (std::getline(ss, part, ','))
+            parts.push_back(part);
+        if (parts.size() == 1)
+            return Vector3f(toFloat(parts[0]));
+        if (parts.size() != 3)
+            fail("expected r,g,b, got '" + s + "'");
+        return Vector3f(toFloat(parts[0]), toFloat(parts[1]), toFloat(parts[2]));
+    }
+
+    void expectArgs(const std::vector<std::string>& tokens, size_t count) const
+    {
+        if (tokens.size() < count + 1)
+            fail("'" + tokens[0] + "' expects " + std::to_string(count) + " arguments");
+    }
+};
+
+//材质参数，默认值与 Object 的构造函数一致
+struct MaterialDesc
+{
+    MaterialType type = DIFFUSE_AND_GLOSSY;
+    Vector3f color = Vector3f(0.2);
+    float ior = 1.3, kd = 0.8, ks = 0.2, exponent = 25;
+
+    void applyTo(Object& object) const
+    {
+        object.materialType = type;
+        object.diffuseColor = color;
+        object.ior = ior;
+        object.Kd = kd;
+        object.Ks = ks;
+        object.specularExponent = exponent;
+    }
+};
+
+MaterialDesc parseMaterial(const LineReader& reader, const std::vector<std::string>& tokens, size_t first)
+{
+    MaterialDesc desc;
+    for (size_t i = first; i < tokens.size(); ++i)
+    {
+        auto eq = tokens[i].find('=');
+        if (eq == std::string::npos)
+            reader.fail("expected key=value, got '" + tokens[i] + "'");
+        std::string key = tokens[i].substr(0, eq), value = tokens[i].substr(eq + 1);
+        if (key == "type")
+        {
+            if (value == "diffuse") desc.type = DIFFUSE_AND_GLOSSY;
+            else if (value == "reflection") desc.type = REFLECTION;
+            else if (value == "glass") desc.type = REFLECTION_AND_REFRACTION;
+            else reader.fail("unknown material type '" + value + "'");
+        }
+        else if (key == "color") desc.color = reader.toVector(value);
+        else if (key == "ior") desc.ior = reader.toFloat(value);
+        else if (key == "kd") desc.kd = reader.toFloat(value);
+        else if (key == "ks") desc.ks = reader.toFloat(value);
+        else if (key == "exponent") desc.exponent = reader.toFloat(value);
+        else reader.fail("unknown material parameter '" + key + "'");
+    }
+    return desc;
+}
+
+} // namespace
+
+Scene& loadSceneFile(const std::string& filename, SceneCache& cache)
+{
+    std::ifstream in(filename);
+    if (!in)
+        throw std::runtime_error("cannot open scene file " + filename);
+
+    LineReader reader;
+    reader.filename = filename;
+
+    Scene defaults(1280, 960);
+    int width = defaults.width, height = defaults.height;
+    double fov = defaults.fov;
+    Vector3f eye = defaults.eye_pos;
+    int maxDepth = defaults.maxDepth;
+    Vector3f background = defaults.backgroundColor;
+    float minRayWeight = defaults.minRayWeight;
+    bool stochastic = defaults.stochasticPruning;
+    std::string output = defaults.output;
+
+    //几何、材质和光源先解析成“构造函数”，只有缓存中没有相同的场景时才真正创建
+    std::string geometryKey;
+    std::vector<std::function<void(Scene&)> > builders;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        reader.lineNumber++;
+        auto comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream ls(line);
+        std::vector<std::string> tokens;
+        for (std::string t; ls >> t;)
+            tokens.push_back(t);
+        if (tokens.empty())
+            continue;
+
+        const std::string& cmd = tokens[0];
+        if (cmd == "resolution")
+        {
+            reader.expectArgs(tokens, 2);
+            width = reader.toInt(tokens[1]);
+            height = reader.toInt(tokens[2]);
+            if (width <= 0 || height <= 0)
+                reader.fail("resolution must be positive");
+        }
+        else if (cmd == "fov")
+        {
+            reader.expectArgs(tokens, 1);
+            fov = reader.toFloat(tokens[1]);
+        }
+        else if (cmd == "camera")
+        {
+            reader.expectArgs(tokens, 3);
+            eye = Vector3f(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+        }
+        else if (cmd == "max_depth")
+        {
+            reader.expectArgs(tokens, 1);
+            maxDepth = reader.toInt(tokens[1]);
+        }
+        else if (cmd == "background")
+        {
+            reader.expectArgs(tokens, 1);
+            background = reader.toVector(tokens[1]);
+        }
+        else if (cmd == "min_ray_weight")
+        {
+            reader.expectArgs(tokens, 1);
+            minRayWeight = reader.toFloat(tokens[1]);
+        }
+        else if (cmd == "stochastic_pruning")
+        {
+            reader.expectArgs(tokens, 1);
+            stochastic = reader.toInt(tokens[1]) != 0;
+        }
+        else if (cmd == "output")
+        {
+            reader.expectArgs(tokens, 1);
+            output = resolvePath(filename, tokens[1]);
+        }
+        else if (cmd == "sphere" || cmd == "quad" || cmd == "light")
+        {
+            for (const auto& t : tokens)
+                geometryKey += t + ' ';
+            geometryKey += '\n';
+
+            if (cmd == "sphere")
+            {
+                reader.expectArgs(tokens, 4);
+                Vector3f center(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+                float radius = reader.toFloat(tokens[4]);
+                MaterialDesc material = parseMaterial(reader, tokens, 5);
+                builders.push_back([=](Scene& scene) {
+                    auto sph = std::make_unique<Sphere>(center, radius);
+                    material.applyTo(*sph);
+                    scene.Add(std::move(sph));
+                });
+            }
+            else if (cmd == "quad")
+            {
+                reader.expectArgs(tokens, 4);
+                std::array<Vector3f, 4> verts;
+                for (int i = 0; i < 4; ++i)
+                    verts[i] = reader.toVector(tokens[i + 1]);
+                MaterialDesc material = parseMaterial(reader, tokens, 5);
+                builders.push_back([=](Scene& scene) {
+                    //与 main.cpp 中的地面一致：沿 1-3 对角线拆成两个三角形，纹理坐标铺满整个四边形
+                    uint32_t vertIndex[6] = {1, 3, 0, 3, 1, 2};
+                    Vector2f st[4] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+                    auto mesh = std::make_unique<MeshTriangle>(verts.data(), vertIndex, 2, st);
+                    material.applyTo(*mesh);
+                    scene.Add(std::move(mesh));
+                });
+            }
+            else
+            {
+                reader.expectArgs(tokens, 4);
+                Vector3f position(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+                Vector3f intensity = reader.toVector(tokens[4]);
+                builders.push_back([=](Scene& scene) {
+                    scene.Add(std::make_unique<Light>(position, intensity));
+                });
+            }
+        }
+        else
+        {
+            reader.fail("unknown directive '" + cmd + "'");
+        }
+    }
+
+    auto& slot = cache.scenes[geometryKey];
+    if (slot)
+    {
+        cache.scenesReused++;
+    }
+    else
+    {
+        slot = std::make_unique<Scene>(width, height);
+        for (auto& build : builders)
+            build(*slot);
+        slot->buildBVH();
+        cache.scenesBuilt++;
+    }
+
+    Scene& scene = *slot;
+    scene.width = width;
+    scene.height = height;
+    scene.fov = fov;
+    scene.eye_pos = eye;
+    scene.maxDepth = maxDepth;
+    scene.backgroundColor = background;
+    scene.minRayWeight = minRayWeight;
+    scene.stochasticPruning = stochastic;
+    scene.output = output;
+    return scene;
+}
+
+std::vector<std::string> collectJobs(int argc, char** argv)
+{
+    std::vector<std::string> jobs;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--jobs")
+        {
+            if (i + 1 >= argc)
+                throw std::runtime_error("--jobs expects a list file");
+            std::string listFile = argv[++i];
+            std::ifstream list(listFile);
+            if (!list)
+                throw std::runtime_error("cannot open job list " + listFile);
+            std::string line;
+            while (std::getline(list, line))
+            {
+                auto comment = line.find('#');
+                if (comment != std::string::npos)
+                    line.erase(comment);
+                std::istringstream ls(line);
+                std::string path;
+                if (ls >> path)
+                    jobs.push_back(resolvePath(listFile, path));
+            }
+        }
+        else
+        {
+            jobs.push_back(arg);
+        }
+    }
+    return jobs;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Scene.hpp"
+
+// 文本场景描述文件，每行一条指令，# 之后为注释，相对路径相对于场景文件所在目录：
+//   resolution <w> <h>
+//   fov <度数>
+//   camera <x> <y> <z>                     视点位置（看向 -z）
+//   max_depth <n>
+//   background <r,g,b>
+//   min_ray_weight <w>                     光线树剪枝阈值，0 表示不剪枝
+//   stochastic_pruning <0|1>
+//   output <file.ppm>
+//   sphere <x> <y> <z> <r> [材质参数]
+//   quad <x,y,z> <x,y,z> <x,y,z> <x,y,z> [材质参数]   四个顶点按顺序给出，拆成 (0,1,3) (1,2,3) 两个三角形
+//   light <x> <y> <z> <intensity>          点光源
+// 材质参数为 key=value：type=diffuse|reflection|glass  color=r,g,b  ior=f  kd=f  ks=f  exponent=f
+// 颜色 / 向量可以写成 r,g,b，也可以只写一个数表示三个分量相同
+
+// 批量渲染时复用的场景：物体、光源和材质指令完全相同的任务共用同一个 Scene（连同它的 BVH），
+// 只更新分辨率、相机、输出文件等渲染参数
+class SceneCache
+{
+public:
+    int scenesBuilt = 0;//新建的场景数
+    int scenesReused = 0;//直接复用的场景数
+
+private:
+    friend Scene& loadSceneFile(const std::string& filename, SceneCache& cache);
+    std::map<std::string, std::unique_ptr<Scene> > scenes;
+};
+
+// 读取一个场景文件，返回的场景已经构建好 BVH，归 cache 所有；
+// 格式错误时抛出 std::runtime_error（带文件名和行号）
+Scene& loadSceneFile(const std::string& filename, SceneCache& cache);
+
+// 解析命令行：参数为场景文件；--jobs <list> 从列表文件读取场景文件（每行一个，# 为注释）
+std::vector<std::string> collectJobs(int argc, char** argv);
@@ -43,6 +43,19 @@ public:
         return true;
     }
 
+    void getPrimitiveBounds(const uint32_t&, Vector3f& pMin, Vector3f& pMax) const override
+    {
+        pMin = center - Vector3f(radius);
+        pMax = center + Vector3f(radius);
+    }
+
+    bool intersectPrimitive(const uint32_t&, const Vector3f& orig, const Vector3f& dir, float& tnear,
+                            Vector2f& uv) const override
+    {
+        uint32_t index = 0;
+        return intersect(orig, dir, tnear, index, uv);
+    }
+
     void getSurfaceProperties(const Vector3f& P, const Vector3f&, const uint32_t&, const Vector2f&,
                               Vector3f& N, Vector2f&) const override
     {
@@ -2,10 +2,11 @@
 
 #include "Object.hpp"
 
+#include <algorithm>
 #include <cstring>
 
 //MT算法:光线和三角形求交
-bool rayTriangleIntersect(const Vector3f& v0, const Vector3f& v1, const Vector3f& v2, const Vector3f& orig,
+inline bool rayTriangleIntersect(const Vector3f& v0, const Vector3f& v1, const Vector3f& v2, const Vector3f& orig,
                           const Vector3f& dir, float& tnear, float& u, float& v)
 {
     
@@ -106,6 +107,31 @@ public:
         return intersect;
     }
 
+    uint32_t getPrimitiveCount() const override
+    {
+        return numTriangles;
+    }
+
+    //第 index 个三角形的包围盒
+    void getPrimitiveBounds(const uint32_t& index, Vector3f& pMin, Vector3f& pMax) const override
+    {
+        const Vector3f& v0 = vertices[vertexIndex[index * 3]];
+        const Vector3f& v1 = vertices[vertexIndex[index * 3 + 1]];
+        const Vector3f& v2 = vertices[vertexIndex[index * 3 + 2]];
+        pMin = Vector3f(std::min({v0.x, v1.x, v2.x}), std::min({v0.y, v1.y, v2.y}), std::min({v0.z, v1.z, v2.z}));
+        pMax = Vector3f(std::max({v0.x, v1.x, v2.x}), std::max({v0.y, v1.y, v2.y}), std::max({v0.z, v1.z, v2.z}));
+    }
+
+    //光线 与 第 index 个三角形求交（BVH 叶子中调用，不再遍历整个网格）
+    bool intersectPrimitive(const uint32_t& index, const Vector3f& orig, const Vector3f& dir, float& tnear,
+                            Vector2f& uv) const override
+    {
+        const Vector3f& v0 = vertices[vertexIndex[index * 3]];
+        const Vector3f& v1 = vertices[vertexIndex[index * 3 + 1]];
+        const Vector3f& v2 = vertices[vertexIndex[index * 3 + 2]];
+        return rayTriangleIntersect(v0, v1, v2, orig, dir, tnear, uv.x, uv.y);
+    }
+
     //获取插值：法线 和 纹理值
     void getSurfaceProperties(const Vector3f&, const Vector3f&, const uint32_t& index, const Vector2f& uv, Vector3f& N,
                               Vector2f& st) const override
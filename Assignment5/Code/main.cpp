@@ -3,12 +3,63 @@
 #include "Triangle.hpp"
 #include "Light.hpp"
 #include "Renderer.hpp"
+#include "SceneFile.hpp"
+#include <chrono>
+
+// 批量模式：RayTracing scene1.scene scene2.scene ... 或 RayTracing --jobs list.txt
+// 所有任务在同一个进程里依次渲染，几何完全相同的任务复用同一个场景和 BVH
+int renderJobs(const std::vector<std::string>& jobs)
+{
+    SceneCache cache;
+    Renderer r;
+    int failed = 0;
+    auto batchStart = std::chrono::system_clock::now();
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        std::cout << "[" << i + 1 << "/" << jobs.size() << "] " << jobs[i] << "\n";
+        Scene* scene = nullptr;
+        try
+        {
+            scene = &loadSceneFile(jobs[i], cache);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << "\n";
+            failed++;
+            continue;
+        }
+        auto start = std::chrono::system_clock::now();
+        r.Render(*scene);
+        auto stop = std::chrono::system_clock::now();
+        std::cout << " -> " << scene->output << " ("
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << " ms)\n";
+    }
+    auto batchStop = std::chrono::system_clock::now();
+    std::cout << "Batch complete: " << jobs.size() - failed << " rendered, " << failed << " failed, "
+              << std::chrono::duration_cast<std::chrono::seconds>(batchStop - batchStart).count() << " seconds\n";
+    std::cout << "Scenes built: " << cache.scenesBuilt << ", reused: " << cache.scenesReused << "\n";
+    return failed == 0 ? 0 : 1;
+}
 
 // In the main function of the program, we create the scene (create objects and lights)
 // as well as set the options for the render (image width and height, maximum recursion
 // depth, field-of-view, etc.). We then call the render function().
-int main()
+int main(int argc, char** argv)
 {
+    std::vector<std::string> jobs;
+    try
+    {
+        jobs = collectJobs(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (!jobs.empty())
+        return renderJobs(jobs);
+
+    //没有参数时渲染内置的场景
     //场景
     Scene scene(1280, 960);
 
@@ -43,6 +94,9 @@ int main()
     scene.Add(std::make_unique<Light>(Vector3f(-20, 70, 20), 0.5));
     scene.Add(std::make_unique<Light>(Vector3f(30, 50, -12), 0.5));    
 
+    //构建 BVH
+    scene.buildBVH();
+
     //渲染
     Renderer r;
     r.Render(scene);
@@ -113,6 +113,10 @@ class Bounds3
     inline bool IntersectP(const Ray& ray, 
                            const Vector3f& invDir,
                            const std::array<int, 3>& dirisNeg) const;
+
+    //SoA 光线批使用的版本：直接传入 float 分量，只在 [0, tMax] 内判断相交
+    inline bool IntersectP(float ox, float oy, float oz,
+                           float invx, float invy, float invz, float tMax) const;
 };
 
 
@@ -173,6 +177,18 @@ inline bool Bounds3::IntersectP(const Ray& ray,
         return false;
 }
 
+//AABBs SoA 光线 和 盒子 是否相交，只接受 [0, tMax] 内的交点
+inline bool Bounds3::IntersectP(float ox, float oy, float oz,
+                                float invx, float invy, float invz, float tMax) const
+{
+    float tx0 = (pMin.x - ox) * invx, tx1 = (pMax.x - ox) * invx;
+    float ty0 = (pMin.y - oy) * invy, ty1 = (pMax.y - oy) * invy;
+    float tz0 = (pMin.z - oz) * invz, tz1 = (pMax.z - oz) * invz;
+    float tEnter = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+    float tExit = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+    return tEnter <= tExit;
+}
+
 //求并集（盒子 并 盒子）
 inline Bounds3 Union(const Bounds3& b1, const Bounds3& b2)
 {
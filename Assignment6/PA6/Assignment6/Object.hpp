@@ -19,6 +19,12 @@ public:
     virtual bool intersect(const Ray& ray) = 0;
     virtual bool intersect(const Ray& ray, float &, uint32_t &) const = 0;
     virtual Intersection getIntersection(Ray _ray) = 0;
+    // 遮挡查询：光线在 tMax 之内与物体有任意交点即返回 true，默认借用 getIntersection
+    virtual bool intersectP(const Ray& ray, float tMax)
+    {
+        Intersection inter = getIntersection(ray);
+        return inter.happened && inter.distance < tMax;
+    }
     virtual void getSurfaceProperties(const Vector3f &, const Vector3f &, const uint32_t &, const Vector2f &, Vector3f &, Vector2f &) const = 0;
     virtual Vector3f evalDiffuseColor(const Vector2f &) const =0;
 
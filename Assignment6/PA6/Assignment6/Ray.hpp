@@ -12,17 +12,17 @@ struct Ray{
     //单位方向向量(_inv为倒数，为了用乘法简化除法)
     Vector3f direction, direction_inv;
 
-    double t;//transportation time,
-    double t_min, t_max; // min >= 0, max <= numeric_limits<double>
+    float t;//transportation time,
+    float t_min, t_max; // min >= 0, max <= numeric_limits<float>
 
-    Ray(const Vector3f& ori, const Vector3f& dir, const double _t = 0.0): origin(ori), direction(dir),t(_t) {
-        direction_inv = Vector3f(1./direction.x, 1./direction.y, 1./direction.z);
+    Ray(const Vector3f& ori, const Vector3f& dir, const float _t = 0.0f): origin(ori), direction(dir),t(_t) {
+        direction_inv = Vector3f(1.f/direction.x, 1.f/direction.y, 1.f/direction.z);
         t_min = 0.0;
-        t_max = std::numeric_limits<double>::max();
+        t_max = std::numeric_limits<float>::max();
     }
 
     //计算出光线走了多远
-    Vector3f operator()(double t) const{return origin+direction*t;}
+    Vector3f operator()(float t) const{return origin+direction*t;}
 
     //友元运算符重载，把内容流入 ostream 以及其派生类中
     friend std::ostream &operator<<(std::ostream& os, const Ray& r)
@@ -20,33 +20,52 @@ void Renderer::Render(const Scene& scene)
 
     float scale = tan(deg2rad(scene.fov * 0.5));
     float imageAspectRatio = scene.width / (float)scene.height;
-    Vector3f eye_pos(-1, 5, 10);
-    int m = 0;
-    for (uint32_t j = 0; j < scene.height; ++j) {
-        for (uint32_t i = 0; i < scene.width; ++i) {
-            // generate primary ray direction
-            float x = (2 * (i + 0.5) / (float)scene.width - 1) *
-                      imageAspectRatio * scale;
-            float y = (1 - 2 * (j + 0.5) / (float)scene.height) * scale;
-            // TODO: Find the x and y positions of the current pixel to get the
-            // direction
-            //  vector that passes through it.
-            // Also, don't forget to multiply both of them with the variable
-            // *scale*, and x (horizontal) variable with the *imageAspectRatio*
-
-            // Don't forget to normalize this direction!
-
-            Vector3f dir = normalize(Vector3f(x, y, -1)); //归一化可以看这个类的声明
-            Ray ray(eye_pos,dir);
-            framebuffer[m++] = scene.castRay(ray,0);
+    Vector3f eye_pos = scene.eye_pos;
+    // 按 kTile x kTile 的小 tile 生成主光线，一个 tile 的光线组成一个光线包整体求交
+    constexpr uint32_t kTile = 8;
+    const uint32_t width = scene.width, height = scene.height;
+    RayStream rays;
+    std::vector<Vector3f> colors;
+    for (uint32_t tj = 0; tj < height; tj += kTile) {
+        uint32_t tjEnd = std::min(tj + kTile, height);
+        for (uint32_t ti = 0; ti < width; ti += kTile) {
+            uint32_t tiEnd = std::min(ti + kTile, width);
+            rays.clear();
+            for (uint32_t j = tj; j < tjEnd; ++j) {
+                for (uint32_t i = ti; i < tiEnd; ++i) {
+                    // generate primary ray direction
+                    float x = (2 * (i + 0.5) / (float)scene.width - 1) *
+                              imageAspectRatio * scale;
+                    float y = (1 - 2 * (j + 0.5) / (float)scene.height) * scale;
+                    // TODO: Find the x and y positions of the current pixel to get the
+                    // direction
+                    //  vector that passes through it.
+                    // Also, don't forget to multiply both of them with the variable
+                    // *scale*, and x (horizontal) variable with the *imageAspectRatio*
 
+                    // Don't forget to normalize this direction!
+
+                    Vector3f dir = normalize(Vector3f(x, y, -1)); //归一化可以看这个类的声明
+                    rays.push(eye_pos, dir);
+                }
+            }
+
+            scene.castRayPacket(rays, colors);
+            size_t r = 0;
+            for (uint32_t j = tj; j < tjEnd; ++j)
+                for (uint32_t i = ti; i < tiEnd; ++i)
+                    framebuffer[j * scene.width + i] = colors[r++];
         }
-        UpdateProgress(j / (float)scene.height);
+        UpdateProgress(tj / (float)scene.height);
     }
     UpdateProgress(1.f);
 
     // save framebuffer to file
-    FILE* fp = fopen("binary.ppm", "wb");
+    FILE* fp = fopen(scene.output.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "Cannot open " << scene.output << " for writing\n";
+        return;
+    }
     (void)fprintf(fp, "P6\n%d %d\n255\n", scene.width, scene.height);
     for (auto i = 0; i < scene.height * scene.width; ++i) {
         static unsigned char color[3];
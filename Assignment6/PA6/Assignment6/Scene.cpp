@@ -7,6 +7,7 @@
 
 void Scene::buildBVH() {
     printf(" - Generating BVH...\n\n");
+    delete this->bvh;
     this->bvh = new BVHAccel(objects, 1, BVHAccel::SplitMethod::NAIVE);
 }
 
@@ -15,6 +16,26 @@ Intersection Scene::intersect(const Ray &ray) const
     return this->bvh->Intersect(ray);
 }
 
+void Scene::intersect(const RayStream &rays, HitStream &hits) const
+{
+    this->bvh->Intersect(rays, hits);
+}
+
+void Scene::intersectPacket(const RayStream &rays, HitStream &hits) const
+{
+    this->bvh->IntersectPacket(rays, hits);
+}
+
+bool Scene::intersectP(const Ray &ray, float maxDistance) const
+{
+    return this->bvh->IntersectP(ray, maxDistance);
+}
+
+void Scene::intersectP(const RayStream &rays, std::vector<uint8_t> &occluded) const
+{
+    this->bvh->IntersectP(rays, occluded);
+}
+
 bool Scene::trace(
         const Ray &ray,
         const std::vector<Object*> &objects,
@@ -55,7 +76,11 @@ Vector3f Scene::castRay(const Ray &ray, int depth) const
     if (depth > this->maxDepth) {
         return Vector3f(0.0,0.0,0.0);
     }
-    Intersection intersection = Scene::intersect(ray);
+    return shade(ray, Scene::intersect(ray), depth, nullptr);
+}
+
+Vector3f Scene::shade(const Ray &ray, const Intersection &intersection, int depth, const uint8_t *shadowed) const
+{
     Material *m = intersection.m;
     Object *hitObject = intersection.obj;
     Vector3f hitColor = this->backgroundColor;
@@ -129,7 +154,7 @@ Vector3f Scene::castRay(const Ray &ray, int depth) const
                         Object *shadowHitObject = nullptr;
                         float tNearShadow = kInfinity;
                         // is the point in shadow, and is the nearest occluding object closer to the object than the light itself?
-                        bool inShadow = bvh->Intersect(Ray(shadowPointOrig, lightDir)).happened;
+                        bool inShadow = shadowed ? shadowed[i] : intersectP(Ray(shadowPointOrig, lightDir), std::sqrt(lightDistance2));
                         lightAmt += (1 - inShadow) * get_lights()[i]->intensity * LdotN;
                         Vector3f reflectionDirection = reflect(-lightDir, N);
                         specularColor += powf(std::max(0.f, -dotProduct(reflectionDirection, ray.direction)),
@@ -143,4 +168,53 @@ Vector3f Scene::castRay(const Ray &ray, int depth) const
     }
 
     return hitColor;
-}
\ No newline at end of file
+}
+void Scene::castRayPacket(const RayStream &rays, std::vector<Vector3f> &colors) const
+{
+    size_t n = rays.size();
+    size_t nLights = get_lights().size();
+    colors.assign(n, this->backgroundColor);
+
+    // 主光线整包求交
+    HitStream hits;
+    intersectPacket(rays, hits);
+
+    // Phong 着色点对每个点光源各发一条阴影光线，同一光源的阴影光线放在同一个光线包里
+    std::vector<uint8_t> shadowed(n * nLights, 0);
+    std::vector<uint8_t> isPhong(n, 0);
+    std::vector<RayStream> shadowRays(nLights);
+    std::vector<std::vector<size_t>> shadowOwner(nLights);
+    for (size_t k = 0; k < n; ++k) {
+        if (!hits.happened[k] || hits.m[k]->getType() != DIFFUSE_AND_GLOSSY)
+            continue;
+        isPhong[k] = 1;
+        Vector3f dir = rays.direction(k);
+        Vector3f hitPoint = Vector3f(hits.px[k], hits.py[k], hits.pz[k]);
+        Vector3f N = Vector3f(hits.nx[k], hits.ny[k], hits.nz[k]);
+        Vector2f uv, st;
+        hits.obj[k]->getSurfaceProperties(hitPoint, dir, 0, uv, N, st);
+        Vector3f shadowPointOrig = (dotProduct(dir, N) < 0) ?
+                                   hitPoint + N * EPSILON :
+                                   hitPoint - N * EPSILON;
+        for (size_t i = 0; i < nLights; ++i) {
+            if (dynamic_cast<AreaLight*>(get_lights()[i].get()))
+                continue;
+            Vector3f lightDir = get_lights()[i]->position - hitPoint;
+            shadowRays[i].push(shadowPointOrig, normalize(lightDir), std::sqrt(dotProduct(lightDir, lightDir)));
+            shadowOwner[i].push_back(k);
+        }
+    }
+
+    std::vector<uint8_t> occluded;
+    for (size_t i = 0; i < nLights; ++i) {
+        intersectP(shadowRays[i], occluded);
+        for (size_t r = 0; r < shadowOwner[i].size(); ++r)
+            shadowed[shadowOwner[i][r] * nLights + i] = occluded[r];
+    }
+
+    for (size_t k = 0; k < n; ++k) {
+        if (!hits.happened[k])
+            continue;
+        colors[k] = shade(rays.ray(k), hits.get(k), 0, isPhong[k] ? &shadowed[k * nLights] : nullptr);
+    }
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include "Vector.hpp"
 #include "Object.hpp"
@@ -26,8 +27,12 @@ public:
 
     int maxDepth = 5;
 
+    Vector3f eye_pos = Vector3f(-1, 5, 10);//视点位置，看向 -z
+    std::string output = "binary.ppm";//输出文件
+
     Scene(int w, int h) : width(w), height(h)
     {}
+    ~Scene() { delete bvh; }
 
     void Add(Object *object) { objects.push_back(object); }
     void Add(std::unique_ptr<Light> light) { lights.push_back(std::move(light)); }
@@ -38,9 +43,22 @@ public:
 
 
     Intersection intersect(const Ray& ray) const;
-    BVHAccel *bvh;
+    // 批量求交，rays 与 hits 按下标一一对应
+    void intersect(const RayStream& rays, HitStream& hits) const;
+    // 光线包求交，适合同一 tile 的主光线和射向同一光源的阴影光线
+    void intersectPacket(const RayStream& rays, HitStream& hits) const;
+    // 遮挡查询：光线在 maxDistance 之内是否被任意物体挡住（阴影光线用）
+    bool intersectP(const Ray& ray, float maxDistance) const;
+    // 批量遮挡查询，每条光线的最大距离为 rays.tmax
+    void intersectP(const RayStream& rays, std::vector<uint8_t>& occluded) const;
+    BVHAccel *bvh = nullptr;
     void buildBVH();
     Vector3f castRay(const Ray &ray, int depth) const;
+    // 按光线包着色：主光线整包求交，Phong 着色点射向同一个点光源的阴影光线整包求交，
+    // 反射 / 折射仍逐条递归 castRay；colors 与 rays 按下标一一对应
+    void castRayPacket(const RayStream &rays, std::vector<Vector3f> &colors) const;
+    // 计算交点颜色；shadowed 非空时为该点对每个光源的遮挡结果（已由光线包求出），为空时逐条求交
+    Vector3f shade(const Ray &ray, const Intersection &intersection, int depth, const uint8_t *shadowed) const;
 
     bool trace(const Ray &ray, const std::vector<Object*> &objects, float &tNear, uint32_t &index, Object **hitObject);
     
@@ -0,0 +1,239 @@
+//
+// 场景文件解析与批量渲染的资源缓存
+//
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "SceneFile.hpp"
+#include "Triangle.hpp"
+#include "Sphere.hpp"
+
+namespace {
+
+std::string directoryOf(const std::string& path)
+{
+    auto pos = path.find_last_of('/');
+    return pos == std::string::npos ? std::string() : path.substr(0, pos + 1);
+}
+
+std::string resolvePath(const std::string& base, const std::string& path)
+{
+    if (path.empty() || path[0] == '/')
+        return path;
+    return directoryOf(base) + path;
+}
+
+std::string vectorKey(const Vector3f& v)
+{
+    std::ostringstream os;
+    os << v.x << ',' << v.y << ',' << v.z;
+    return os.str();
+}
+
+// 逐行读取场景文件，记录行号，出错时给出位置
+struct LineReader {
+    std::string filename;
+    int lineNumber = 0;
+
+    [[noreturn]] void fail(const std::string& message) const
+    {
+        throw std::runtime_error(filename + ":" + std::to_string(lineNumber) + ": " + message);
+    }
+
+    float toFloat(const std::string& s) const
+    {
+        try {
+            size_t used = 0;
+            float v = std::stof(s, &used);
+            if (used == s.size())
+                return v;
+        }
+        catch (const std::exception&) {}
+        fail("expected a number, got '" + s + "'");
+    }
+
+    int toInt(const std::string& s) const
+    {
+        float v = toFloat(s);
+        if (v != (int)v)
+            fail("expected an integer, got '" + s + "'");
+        return (int)v;
+    }
+
+    // "r,g,b" 或单个数字
+    Vector3f toVector(const std::string& s) const
+    {
+        std::vector<std::string> parts;
+        std::stringstream ss(s);
+        std::string part;
+        while (std::getline(ss, part, ','))
+            parts.push_back(part);
+        if (parts.size() == 1)
+            return Vector3f(toFloat(parts[0]));
+        if (parts.size() != 3)
+            fail("expected r,g,b, got '" + s + "'");
+        return Vector3f(toFloat(parts[0]), toFloat(parts[1]), toFloat(parts[2]));
+    }
+
+    void expectArgs(const std::vector<std::string>& tokens, size_t count) const
+    {
+        if (tokens.size() < count + 1)
+            fail("'" + tokens[0] + "' expects " + std::to_string(count) + " arguments");
+    }
+};
+
+} // namespace
+
+Object* AssetCache::mesh(const std::string& path, float scale)
+{
+    std::ostringstream key;
+    key << "mesh " << path << ' ' << scale;
+    auto& slot = objects[key.str()];
+    if (slot) {
+        objectsReused++;
+        return slot.get();
+    }
+    std::ifstream probe(path);
+    if (!probe)
+        throw std::runtime_error("cannot open mesh " + path);
+    slot = std::make_unique<MeshTriangle>(path, scale);
+    objectsCreated++;
+    return slot.get();
+}
+
+Object* AssetCache::sphere(const Vector3f& center, float radius)
+{
+    std::ostringstream key;
+    key << "sphere " << vectorKey(center) << ' ' << radius;
+    auto& slot = objects[key.str()];
+    if (slot) {
+        objectsReused++;
+        return slot.get();
+    }
+    slot = std::make_unique<Sphere>(center, radius);
+    objectsCreated++;
+    return slot.get();
+}
+
+std::unique_ptr<Scene> loadSceneFile(const std::string& filename, AssetCache& cache)
+{
+    std::ifstream in(filename);
+    if (!in)
+        throw std::runtime_error("cannot open scene file " + filename);
+
+    LineReader reader;
+    reader.filename = filename;
+
+    int width = 1280, height = 960;
+    Scene defaults(width, height);
+    double fov = defaults.fov;
+    Vector3f eye = defaults.eye_pos;
+    int maxDepth = defaults.maxDepth;
+    std::string output = defaults.output;
+    std::vector<Object*> objects;
+    std::vector<std::unique_ptr<Light> > lights;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        reader.lineNumber++;
+        auto comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream ls(line);
+        std::vector<std::string> tokens;
+        for (std::string t; ls >> t;)
+            tokens.push_back(t);
+        if (tokens.empty())
+            continue;
+
+        const std::string& cmd = tokens[0];
+        if (cmd == "resolution") {
+            reader.expectArgs(tokens, 2);
+            width = reader.toInt(tokens[1]);
+            height = reader.toInt(tokens[2]);
+            if (width <= 0 || height <= 0)
+                reader.fail("resolution must be positive");
+        }
+        else if (cmd == "fov") {
+            reader.expectArgs(tokens, 1);
+            fov = reader.toFloat(tokens[1]);
+        }
+        else if (cmd == "camera") {
+            reader.expectArgs(tokens, 3);
+            eye = Vector3f(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+        }
+        else if (cmd == "max_depth") {
+            reader.expectArgs(tokens, 1);
+            maxDepth = reader.toInt(tokens[1]);
+        }
+        else if (cmd == "output") {
+            reader.expectArgs(tokens, 1);
+            output = resolvePath(filename, tokens[1]);
+        }
+        else if (cmd == "mesh") {
+            reader.expectArgs(tokens, 1);
+            float scale = tokens.size() > 2 ? reader.toFloat(tokens[2]) : 60.f;
+            try {
+                objects.push_back(cache.mesh(resolvePath(filename, tokens[1]), scale));
+            }
+            catch (const std::runtime_error& e) {
+                reader.fail(e.what());
+            }
+        }
+        else if (cmd == "sphere") {
+            reader.expectArgs(tokens, 4);
+            Vector3f center(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+            objects.push_back(cache.sphere(center, reader.toFloat(tokens[4])));
+        }
+        else if (cmd == "light") {
+            reader.expectArgs(tokens, 4);
+            Vector3f position(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+            lights.push_back(std::make_unique<Light>(position, reader.toVector(tokens[4])));
+        }
+        else {
+            reader.fail("unknown directive '" + cmd + "'");
+        }
+    }
+
+    auto scene = std::make_unique<Scene>(width, height);
+    scene->fov = fov;
+    scene->eye_pos = eye;
+    scene->maxDepth = maxDepth;
+    scene->output = output;
+    for (auto* object : objects)
+        scene->Add(object);
+    for (auto& light : lights)
+        scene->Add(std::move(light));
+    return scene;
+}
+
+std::vector<std::string> collectJobs(int argc, char** argv)
+{
+    std::vector<std::string> jobs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--jobs") {
+            if (i + 1 >= argc)
+                throw std::runtime_error("--jobs expects a list file");
+            std::string listFile = argv[++i];
+            std::ifstream list(listFile);
+            if (!list)
+                throw std::runtime_error("cannot open job list " + listFile);
+            std::string line;
+            while (std::getline(list, line)) {
+                auto comment = line.find('#');
+                if (comment != std::string::npos)
+                    line.erase(comment);
+                std::istringstream ls(line);
+                std::string path;
+                if (ls >> path)
+                    jobs.push_back(resolvePath(listFile, path));
+            }
+        }
+        else {
+            jobs.push_back(arg);
+        }
+    }
+    return jobs;
+}
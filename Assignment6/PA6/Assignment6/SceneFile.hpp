@@ -0,0 +1,44 @@
+//
+// 文本场景描述文件，以及批量渲染时在多个任务之间共享的资源缓存
+//
+// 每行一条指令，# 之后为注释，相对路径相对于场景文件所在目录：
+//   resolution <w> <h>
+//   fov <度数>
+//   camera <x> <y> <z>                  视点位置（看向 -z）
+//   max_depth <n>
+//   output <file.ppm>
+//   mesh <file.obj> [scale]             scale 默认 60
+//   sphere <x> <y> <z> <r>
+//   light <x> <y> <z> <intensity>       点光源
+// 强度可以写成 r,g,b，也可以只写一个数表示三个分量相同
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Scene.hpp"
+
+// 多个渲染任务共享的资源：同一个文件 + 同一缩放系数的网格（连同它内部的 BVH）、
+// 参数相同的球体都只创建一次，后面的任务直接复用
+class AssetCache
+{
+public:
+    Object* mesh(const std::string& path, float scale);
+    Object* sphere(const Vector3f& center, float radius);
+
+    int objectsCreated = 0;//新创建的物体数
+    int objectsReused = 0;//直接复用缓存的物体数
+
+private:
+    std::map<std::string, std::unique_ptr<Object> > objects;
+};
+
+// 读取一个场景文件，物体从 cache 中获取；格式错误时抛出 std::runtime_error（带文件名和行号）
+// 返回的场景还没有构建 BVH
+std::unique_ptr<Scene> loadSceneFile(const std::string& filename, AssetCache& cache);
+
+// 解析命令行：参数为场景文件；--jobs <list> 从列表文件读取场景文件（每行一个，# 为注释）
+std::vector<std::string> collectJobs(int argc, char** argv);
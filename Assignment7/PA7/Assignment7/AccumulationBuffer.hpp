@@ -0,0 +1,191 @@
+//
+// 渐进式渲染的累积缓冲：每个像素用 Welford 算法在线维护颜色均值、亮度的均值和二阶中心矩 M2
+// 以及样本数，可以写入检查点文件，之后从检查点继续渲染
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Vector.hpp"
+#include "global.hpp"
+
+inline float luminance(const Vector3f& c)
+{
+    return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+}
+
+class AccumulationBuffer
+{
+public:
+    AccumulationBuffer(int w, int h)
+        : width(w), height(h), mean_(w * h), lumMean(w * h, 0.0f), lumM2(w * h, 0.0f), count(w * h, 0)
+    {}
+
+    // Welford 更新，比累加平方和再相减数值上更稳定；每个像素只由一个线程写入，不需要加锁
+    void add(int pixel, const Vector3f& color)
+    {
+        uint32_t n = ++count[pixel];
+        mean_[pixel] += (color - mean_[pixel]) / n;
+        float l = luminance(color);
+        float delta = l - lumMean[pixel];
+        lumMean[pixel] += delta / n;
+        lumM2[pixel] += delta * (l - lumMean[pixel]);
+    }
+
+    Vector3f mean(int pixel) const { return mean_[pixel]; }
+
+    uint32_t samples(int pixel) const { return count[pixel]; }
+
+    // 像素均值（亮度）的方差估计 s^2 / n，样本不足两个时返回无穷大
+    float varianceOfMean(int pixel) const
+    {
+        uint32_t n = count[pixel];
+        if (n < 2)
+            return kInfinity;
+        return lumM2[pixel] / (n - 1) / n;
+    }
+
+    // 相对误差：均值的标准差 / 均值；分母加上 kRelativeErrorFloor，避免暗部像素永远不收敛
+    float relativeError(int pixel) const
+    {
+        return std::sqrt(varianceOfMean(pixel)) / (lumMean[pixel] + kRelativeErrorFloor);
+    }
+
+    // 全图平均的均值方差，用来判断是否达到目标质量
+    float averageVariance() const
+    {
+        double total = 0;
+        for (int i = 0; i < width * height; ++i)
+            total += varianceOfMean(i);
+        return float(total / (width * height));
+    }
+
+    // 标记下一轮还要采样的像素：样本数没到 maxSpp，并且少于 minSpp 或相对误差仍高于 threshold；
+    // threshold 为 0 时不做自适应，所有没到 maxSpp 的像素都要采样。返回要采样的像素数
+    int markActive(uint32_t maxSpp, uint32_t minSpp, float threshold, std::vector<uint8_t>& active) const
+    {
+        active.resize(count.size());
+        int n = 0;
+        for (size_t i = 0; i < count.size(); ++i) {
+            active[i] = count[i] < maxSpp && (threshold <= 0 || count[i] < minSpp || relativeError(i) > threshold);
+            n += active[i];
+        }
+        return n;
+    }
+
+    // 所有像素中最少的样本数
+    uint32_t minSamples() const
+    {
+        uint32_t n = UINT32_MAX;
+        for (uint32_t c : count)
+            n = std::min(n, c);
+        return count.empty() ? 0 : n;
+    }
+
+    uint64_t totalSamples() const
+    {
+        uint64_t n = 0;
+        for (uint32_t c : count)
+            n += c;
+        return n;
+    }
+
+    // 检查点格式：魔数、宽、高，然后依次是 mean / lumMean / lumM2 / count 四个数组（本机字节序）
+    // 先写到临时文件再改名，写到一半被打断时旧的检查点仍然完整
+    bool save(const std::string& path) const
+    {
+        std::string tmp = path + ".tmp";
+        FILE* fp = fopen(tmp.c_str(), "wb");
+        if (!fp)
+            return false;
+        int32_t header[2] = {width, height};
+        bool ok = fwrite(kMagic, 1, sizeof(kMagic), fp) == sizeof(kMagic)
+                  && fwrite(header, sizeof(header), 1, fp) == 1
+                  && fwrite(mean_.data(), sizeof(Vector3f), mean_.size(), fp) == mean_.size()
+                  && fwrite(lumMean.data(), sizeof(float), lumMean.size(), fp) == lumMean.size()
+                  && fwrite(lumM2.data(), sizeof(float), lumM2.size(), fp) == lumM2.size()
+                  && fwrite(count.data(), sizeof(uint32_t), count.size(), fp) == count.size();
+        ok = (fclose(fp) == 0) && ok;
+        return ok && std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+    // 读取检查点；文件不存在、格式不对或分辨率不一致时返回 false，缓冲保持不变
+    bool load(const std::string& path)
+    {
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (!fp)
+            return false;
+        char magic[sizeof(kMagic)];
+        int32_t header[2];
+        std::vector<Vector3f> m(mean_.size());
+        std::vector<float> lm(lumMean.size()), m2(lumM2.size());
+        std::vector<uint32_t> c(count.size());
+        bool ok = fread(magic, 1, sizeof(magic), fp) == sizeof(magic)
+                  && std::equal(magic, magic + sizeof(magic), kMagic)
+                  && fread(header, sizeof(header), 1, fp) == 1
+                  && header[0] == width && header[1] == height
+                  && fread(m.data(), sizeof(Vector3f), m.size(), fp) == m.size()
+                  && fread(lm.data(), sizeof(float), lm.size(), fp) == lm.size()
+                  && fread(m2.data(), sizeof(float), m2.size(), fp) == m2.size()
+                  && fread(c.data(), sizeof(uint32_t), c.size(), fp) == c.size();
+        fclose(fp);
+        if (!ok)
+            return false;
+        mean_.swap(m);
+        lumMean.swap(lm);
+        lumM2.swap(m2);
+        count.swap(c);
+        return true;
+    }
+
+    // 按均值输出 PPM，gamma 与原来的 framebuffer 输出一致
+    bool writeImage(const std::string& path) const
+    {
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (!fp)
+            return false;
+        (void)fprintf(fp, "P6\n%d %d\n255\n", width, height);
+        for (int i = 0; i < width * height; ++i) {
+            Vector3f c = mean(i);
+            unsigned char color[3];
+            color[0] = (unsigned char)(255 * std::pow(clamp(0, 1, c.x), 0.6f));
+            color[1] = (unsigned char)(255 * std::pow(clamp(0, 1, c.y), 0.6f));
+            color[2] = (unsigned char)(255 * std::pow(clamp(0, 1, c.z), 0.6f));
+            fwrite(color, 1, 3, fp);
+        }
+        return fclose(fp) == 0;
+    }
+
+    // 采样数热力图：按样本数从少到多映射为 蓝 -> 绿 -> 红，用来检查自适应采样把样本花在了哪里
+    bool writeSampleMap(const std::string& path) const
+    {
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (!fp)
+            return false;
+        uint32_t maxCount = 1;
+        for (uint32_t c : count)
+            maxCount = std::max(maxCount, c);
+        (void)fprintf(fp, "P6\n%d %d\n255\n", width, height);
+        for (int i = 0; i < width * height; ++i) {
+            float t = float(count[i]) / maxCount;
+            float r = clamp(0, 1, 2 * t - 1), b = clamp(0, 1, 1 - 2 * t), g = 1 - r - b;
+            unsigned char color[3] = {(unsigned char)(255 * r), (unsigned char)(255 * g), (unsigned char)(255 * b)};
+            fwrite(color, 1, 3, fp);
+        }
+        return fclose(fp) == 0;
+    }
+
+    int width, height;
+
+private:
+    static constexpr char kMagic[8] = {'P', 'A', '7', 'A', 'C', 'C', '2', '\n'};
+    static constexpr float kRelativeErrorFloor = 1e-2f;
+
+    std::vector<Vector3f> mean_;
+    std::vector<float> lumMean, lumM2;
+    std::vector<uint32_t> count;
+};
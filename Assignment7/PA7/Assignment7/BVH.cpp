@@ -1,18 +1,79 @@
 #include <algorithm>
 #include <cassert>
+#include <future>
+#include <thread>
 #include "BVH.hpp"
 
+// 构建时每个图元只计算一次包围盒和质心，避免排序时反复调用 getBounds()
+struct BVHPrimitiveInfo {
+    BVHPrimitiveInfo() {}
+    BVHPrimitiveInfo(Object* object, const Bounds3& bounds)
+        : object(object), bounds(bounds), centroid(0.5f * bounds.pMin + 0.5f * bounds.pMax) {}
+    Object* object = nullptr;
+    Bounds3 bounds;
+    Vector3f centroid;
+};
+
+struct MortonPrimitive {
+    int primitiveIndex;
+    uint32_t mortonCode;
+};
+
+// 子区间小于该值时不再派生新任务，避免线程开销超过收益
+static constexpr int kParallelBuildThreshold = 4096;
+
+static int buildThreadCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+static int maxParallelDepth()
+{
+    int threads = buildThreadCount();
+    int depth = 0;
+    while ((1 << depth) < threads) depth++;
+    return depth + 1;
+}
+
+// 把 [0, count) 按线程数均分成若干块，每块一个线程执行 func(begin, end)
+template <typename Func>
+static void parallelChunks(int count, Func func)
+{
+    int nChunks = count < kParallelBuildThreshold ? 1 : buildThreadCount();
+    int chunkSize = (count + nChunks - 1) / nChunks;
+    if (nChunks == 1) {
+        func(0, count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (int begin = 0; begin < count; begin += chunkSize)
+        workers.emplace_back(func, begin, std::min(begin + chunkSize, count));
+    for (auto& t : workers) t.join();
+}
+
 BVHAccel::BVHAccel(std::vector<Object*> p, int maxPrimsInNode,
                    SplitMethod splitMethod)
-    : maxPrimsInNode(std::min(255, maxPrimsInNode)), splitMethod(splitMethod),
-      primitives(std::move(p))
+    : root(nullptr), maxPrimsInNode(std::min(255, maxPrimsInNode)),
+      splitMethod(splitMethod), primitives(std::move(p))
 {
     time_t start, stop;
     time(&start);
     if (primitives.empty())
         return;
 
-    root = recursiveBuild(primitives);
+    int n = primitives.size();
+    std::vector<BVHPrimitiveInfo> primitiveInfo(n);
+    parallelChunks(n, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            primitiveInfo[i] = BVHPrimitiveInfo(primitives[i], primitives[i]->getBounds());
+    });
+
+    nodes.resize(2 * n - 1);
+    totalNodes = 0;
+    if (splitMethod == SplitMethod::LBVH)
+        root = buildLBVH(primitiveInfo);
+    else
+        root = recursiveBuild(primitiveInfo, 0, n, 0);
 
     time(&stop);
     double diff = difftime(stop, start);
@@ -25,74 +86,219 @@ BVHAccel::BVHAccel(std::vector<Object*> p, int maxPrimsInNode,
         hrs, mins, secs);
 }
 
-BVHBuildNode* BVHAccel::recursiveBuild(std::vector<Object*> objects)
+BVHAccel::~BVHAccel() {}
+
+Bounds3 BVHAccel::WorldBound() const
 {
-    BVHBuildNode* node = new BVHBuildNode();
+    return root ? root->bounds : Bounds3();
+}
 
-    // Compute bounds of all primitives in BVH node
-    Bounds3 bounds;
-    for (int i = 0; i < objects.size(); ++i)
-        bounds = Union(bounds, objects[i]->getBounds());
-    if (objects.size() == 1) {
-        // Create leaf _BVHBuildNode_
-        node->bounds = objects[0]->getBounds();
-        node->object = objects[0];
-        node->left = nullptr;
-        node->right = nullptr;
-        node->area = objects[0]->getArea();
-        return node;
-    }
-    else if (objects.size() == 2) {
-        node->left = recursiveBuild(std::vector{objects[0]});
-        node->right = recursiveBuild(std::vector{objects[1]});
-
-        node->bounds = Union(node->left->bounds, node->right->bounds);
-        node->area = node->left->area + node->right->area;
-        return node;
-    }
-    else {
+BVHBuildNode* BVHAccel::allocNode()
+{
+    // 多个构建任务同时取节点，用原子计数分配下标
+    int index = totalNodes.fetch_add(1);
+    assert(index < (int)nodes.size());
+    return &nodes[index];
+}
+
+BVHBuildNode* BVHAccel::createLeaf(Object* object)
+{
+    // Create leaf _BVHBuildNode_
+    BVHBuildNode* node = allocNode();
+    node->bounds = object->getBounds();
+    node->object = object;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->area = object->getArea();
+    node->nPrimitives = 1;
+    return node;
+}
+
+BVHBuildNode* BVHAccel::recursiveBuild(std::vector<BVHPrimitiveInfo>& primitiveInfo,
+                                       int start, int end, int depth)
+{
+    int nPrimitives = end - start;
+    if (nPrimitives == 1)
+        return createLeaf(primitiveInfo[start].object);
+
+    BVHBuildNode* node = allocNode();
+    int mid = start + nPrimitives / 2;
+    if (nPrimitives > 2) {
         Bounds3 centroidBounds;
-        for (int i = 0; i < objects.size(); ++i)
-            centroidBounds =
-                Union(centroidBounds, objects[i]->getBounds().Centroid());
+        for (int i = start; i < end; ++i)
+            centroidBounds = Union(centroidBounds, primitiveInfo[i].centroid);
         int dim = centroidBounds.maxExtent();
-        switch (dim) {
-        case 0:
-            std::sort(objects.begin(), objects.end(), [](auto f1, auto f2) {
-                return f1->getBounds().Centroid().x <
-                       f2->getBounds().Centroid().x;
-            });
-            break;
-        case 1:
-            std::sort(objects.begin(), objects.end(), [](auto f1, auto f2) {
-                return f1->getBounds().Centroid().y <
-                       f2->getBounds().Centroid().y;
-            });
-            break;
-        case 2:
-            std::sort(objects.begin(), objects.end(), [](auto f1, auto f2) {
-                return f1->getBounds().Centroid().z <
-                       f2->getBounds().Centroid().z;
-            });
-            break;
+        node->splitAxis = dim;
+
+        // 只需要按中位数划分，nth_element 为 O(n)，不必整体排序
+        std::nth_element(primitiveInfo.begin() + start, primitiveInfo.begin() + mid,
+                         primitiveInfo.begin() + end,
+                         [dim](const BVHPrimitiveInfo& a, const BVHPrimitiveInfo& b) {
+                             return a.centroid[dim] < b.centroid[dim];
+                         });
+    }
+
+    // 左右子区间互不重叠，可以交给不同线程同时构建
+    if (nPrimitives > kParallelBuildThreshold && depth < maxParallelDepth()) {
+        auto left = std::async(std::launch::async, [&]() {
+            return recursiveBuild(primitiveInfo, start, mid, depth + 1);
+        });
+        node->right = recursiveBuild(primitiveInfo, mid, end, depth + 1);
+        node->left = left.get();
+    }
+    else {
+        node->left = recursiveBuild(primitiveInfo, start, mid, depth + 1);
+        node->right = recursiveBuild(primitiveInfo, mid, end, depth + 1);
+    }
+
+    node->bounds = Union(node->left->bounds, node->right->bounds);
+    node->area = node->left->area + node->right->area;
+    node->nPrimitives = nPrimitives;
+    return node;
+}
+
+// 把 10 位整数的每一位之间插入两个 0，用于交织出 30 位的 Morton 码
+static inline uint32_t leftShift3(uint32_t x)
+{
+    if (x == (1 << 10)) --x;
+    x = (x | (x << 16)) & 0x030000FF;
+    x = (x | (x << 8)) & 0x0300F00F;
+    x = (x | (x << 4)) & 0x030C30C3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+static inline uint32_t encodeMorton3(const Vector3f& v)
+{
+    return (leftShift3(v.z) << 2) | (leftShift3(v.y) << 1) | leftShift3(v.x);
+}
+
+// 按 LSD 基数排序 Morton 码，每一趟先并行统计各块的桶计数，再并行分发
+static void radixSort(std::vector<MortonPrimitive>* v)
+{
+    constexpr int bitsPerPass = 6;
+    constexpr int nBits = 30;
+    constexpr int nPasses = nBits / bitsPerPass;
+    constexpr int nBuckets = 1 << bitsPerPass;
+    constexpr int bitMask = nBuckets - 1;
+
+    int n = v->size();
+    int nChunks = n < kParallelBuildThreshold ? 1 : buildThreadCount();
+    int chunkSize = (n + nChunks - 1) / nChunks;
+    auto forEachChunk = [&](auto func) {
+        std::vector<std::thread> workers;
+        for (int c = 0; c < nChunks; ++c)
+            workers.emplace_back(func, c, std::min(n, c * chunkSize), std::min(n, (c + 1) * chunkSize));
+        for (auto& t : workers) t.join();
+    };
+
+    std::vector<MortonPrimitive> tempVector(n);
+    std::vector<std::array<int, nBuckets>> chunkCounts(nChunks);
+    for (int pass = 0; pass < nPasses; ++pass) {
+        int lowBit = pass * bitsPerPass;
+        std::vector<MortonPrimitive>& in = (pass & 1) ? tempVector : *v;
+        std::vector<MortonPrimitive>& out = (pass & 1) ? *v : tempVector;
+
+        // 每个块各自统计桶计数
+        forEachChunk([&](int c, int begin, int end) {
+            chunkCounts[c].fill(0);
+            for (int i = begin; i < end; ++i)
+                chunkCounts[c][(in[i].mortonCode >> lowBit) & bitMask]++;
+        });
+
+        // 桶优先、块其次的前缀和，保证排序稳定
+        int offset = 0;
+        for (int bucket = 0; bucket < nBuckets; ++bucket)
+            for (int c = 0; c < nChunks; ++c) {
+                int count = chunkCounts[c][bucket];
+                chunkCounts[c][bucket] = offset;
+                offset += count;
+            }
+
+        forEachChunk([&](int c, int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                out[chunkCounts[c][(in[i].mortonCode >> lowBit) & bitMask]++] = in[i];
+        });
+    }
+    if (nPasses & 1) std::swap(*v, tempVector);
+}
+
+BVHBuildNode* BVHAccel::buildLBVH(const std::vector<BVHPrimitiveInfo>& primitiveInfo)
+{
+    int n = primitiveInfo.size();
+    Bounds3 centroidBounds;
+    for (const auto& info : primitiveInfo)
+        centroidBounds = Union(centroidBounds, info.centroid);
+
+    // 质心量化到 [0, 1024)^3 后计算 Morton 码
+    std::vector<MortonPrimitive> mortonPrims(n);
+    parallelChunks(n, [&](int begin, int end) {
+        constexpr int mortonScale = 1 << 10;
+        for (int i = begin; i < end; ++i) {
+            mortonPrims[i].primitiveIndex = i;
+            Vector3f offset = centroidBounds.Offset(primitiveInfo[i].centroid);
+            mortonPrims[i].mortonCode = encodeMorton3(offset * mortonScale);
         }
+    });
+
+    radixSort(&mortonPrims);
 
-        auto beginning = objects.begin();
-        auto middling = objects.begin() + (objects.size() / 2);
-        auto ending = objects.end();
+    // 叶子直接引用 Object*，所以这里把排序结果写回 primitives 中的顺序即可
+    for (int i = 0; i < n; ++i)
+        primitives[i] = primitiveInfo[mortonPrims[i].primitiveIndex].object;
 
-        auto leftshapes = std::vector<Object*>(beginning, middling);
-        auto rightshapes = std::vector<Object*>(middling, ending);
+    return emitLBVH(mortonPrims, 0, n, 29, 0);
+}
+
+BVHBuildNode* BVHAccel::emitLBVH(const std::vector<MortonPrimitive>& mortonPrims,
+                                 int start, int end, int bitIndex, int depth)
+{
+    int nPrimitives = end - start;
+    if (nPrimitives == 1)
+        return createLeaf(primitives[start]);
 
-        assert(objects.size() == (leftshapes.size() + rightshapes.size()));
+    int mid;
+    if (bitIndex < 0) {
+        // Morton 码完全相同，无法再按位区分，直接从中间划分
+        mid = start + nPrimitives / 2;
+    }
+    else {
+        uint32_t mask = 1u << bitIndex;
+        // 区间首尾在该位上相同，说明整段都落在同一侧，继续看下一位
+        if ((mortonPrims[start].mortonCode & mask) ==
+            (mortonPrims[end - 1].mortonCode & mask))
+            return emitLBVH(mortonPrims, start, end, bitIndex - 1, depth);
 
-        node->left = recursiveBuild(leftshapes);
-        node->right = recursiveBuild(rightshapes);
+        // 二分查找该位从 0 变为 1 的位置
+        int lo = start, hi = end - 1;
+        while (lo + 1 != hi) {
+            int m = (lo + hi) / 2;
+            if ((mortonPrims[lo].mortonCode & mask) == (mortonPrims[m].mortonCode & mask))
+                lo = m;
+            else
+                hi = m;
+        }
+        mid = hi;
+    }
 
-        node->bounds = Union(node->left->bounds, node->right->bounds);
-        node->area = node->left->area + node->right->area;
+    BVHBuildNode* node = allocNode();
+    node->splitAxis = bitIndex < 0 ? 0 : bitIndex % 3;
+    int nextBit = bitIndex - 1;
+    if (nPrimitives > kParallelBuildThreshold && depth < maxParallelDepth()) {
+        auto left = std::async(std::launch::async, [&]() {
+            return emitLBVH(mortonPrims, start, mid, nextBit, depth + 1);
+        });
+        node->right = emitLBVH(mortonPrims, mid, end, nextBit, depth + 1);
+        node->left = left.get();
+    }
+    else {
+        node->left = emitLBVH(mortonPrims, start, mid, nextBit, depth + 1);
+        node->right = emitLBVH(mortonPrims, mid, end, nextBit, depth + 1);
     }
 
+    node->bounds = Union(node->left->bounds, node->right->bounds);
+    node->area = node->left->area + node->right->area;
+    node->nPrimitives = nPrimitives;
     return node;
 }
 
@@ -105,6 +311,259 @@ Intersection BVHAccel::Intersect(const Ray& ray) const
     return isect;
 }
 
+// 单条光线的迭代遍历：近的子节点先访问，并用当前最近交点裁剪远处节点
+Intersection BVHAccel::traverseRay(const RayStream& rays, size_t i) const
+{
+    float ox = rays.ox[i], oy = rays.oy[i], oz = rays.oz[i];
+    float invx = rays.invdx[i], invy = rays.invdy[i], invz = rays.invdz[i];
+    std::array<bool, 3> dirIsNeg{ invx < 0, invy < 0, invz < 0 };
+    float tClosest = rays.tmax[i];
+    Intersection closest;
+    Ray ray = rays.ray(i);
+
+    BVHBuildNode* stack[128];
+    int sp = 0;
+    stack[sp++] = root;
+    while (sp > 0) {
+        BVHBuildNode* node = stack[--sp];
+        if (!node->bounds.IntersectP(ox, oy, oz, invx, invy, invz, tClosest))
+            continue;
+        if (node->left == nullptr && node->right == nullptr) {
+            Intersection inter = node->object->getIntersection(ray);
+            if (inter.happened && inter.distance < tClosest) {
+                closest = inter;
+                tClosest = inter.distance;
+            }
+            continue;
+        }
+        // 后入栈的先访问：沿划分轴方向更近的子节点放在栈顶
+        if (dirIsNeg[node->splitAxis]) {
+            stack[sp++] = node->left;
+            stack[sp++] = node->right;
+        }
+        else {
+            stack[sp++] = node->right;
+            stack[sp++] = node->left;
+        }
+    }
+    return closest;
+}
+
+void BVHAccel::Intersect(const RayStream& rays, HitStream& hits) const
+{
+    hits.resize(rays.size());
+    if (!root)
+        return;
+    for (size_t i = 0; i < rays.size(); ++i)
+        hits.set(i, traverseRay(rays, i));
+}
+
+// 一包光线的起点区间和方向倒数区间（每个轴上方向符号必须一致）
+struct PacketInterval {
+    float oMin[3], oMax[3];
+    float invMin[3], invMax[3];
+    bool dirIsNeg[3];
+
+    bool init(const RayStream& rays, size_t begin, size_t end)
+    {
+        const float* o[3] = { rays.ox.data(), rays.oy.data(), rays.oz.data() };
+        const float* inv[3] = { rays.invdx.data(), rays.invdy.data(), rays.invdz.data() };
+        for (int a = 0; a < 3; ++a) {
+            oMin[a] = invMin[a] = std::numeric_limits<float>::infinity();
+            oMax[a] = invMax[a] = -std::numeric_limits<float>::infinity();
+            dirIsNeg[a] = inv[a][begin] < 0;
+            for (size_t i = begin; i < end; ++i) {
+                if (!std::isfinite(inv[a][i]) || (inv[a][i] < 0) != dirIsNeg[a])
+                    return false;
+                oMin[a] = std::min(oMin[a], o[a][i]);
+                oMax[a] = std::max(oMax[a], o[a][i]);
+                invMin[a] = std::min(invMin[a], inv[a][i]);
+                invMax[a] = std::max(invMax[a], inv[a][i]);
+            }
+        }
+        return true;
+    }
+
+    // 保守测试：只要包内可能有一条光线在 [0, tMax] 内穿过包围盒就返回 true
+    bool mayIntersect(const Bounds3& b, float tMax) const
+    {
+        float tEnter = 0.0f, tExit = tMax;
+        for (int a = 0; a < 3; ++a) {
+            float entryPlane = dirIsNeg[a] ? b.pMax[a] : b.pMin[a];
+            float exitPlane = dirIsNeg[a] ? b.pMin[a] : b.pMax[a];
+            // (plane - o) * inv 的区间下界 / 上界
+            float e0 = entryPlane - oMax[a], e1 = entryPlane - oMin[a];
+            float x0 = exitPlane - oMax[a], x1 = exitPlane - oMin[a];
+            float enterLo = std::min(std::min(e0 * invMin[a], e0 * invMax[a]), std::min(e1 * invMin[a], e1 * invMax[a]));
+            float exitHi = std::max(std::max(x0 * invMin[a], x0 * invMax[a]), std::max(x1 * invMin[a], x1 * invMax[a]));
+            tEnter = std::max(tEnter, enterLo);
+            tExit = std::min(tExit, exitHi);
+            if (tEnter > tExit)
+                return false;
+        }
+        return true;
+    }
+};
+
+void BVHAccel::IntersectPacket(const RayStream& rays, HitStream& hits) const
+{
+    hits.resize(rays.size());
+    if (!root)
+        return;
+
+    for (size_t begin = 0; begin < rays.size(); begin += kPacketSize) {
+        size_t end = std::min(rays.size(), begin + (size_t)kPacketSize);
+        PacketInterval packet;
+        if (!packet.init(rays, begin, end)) {
+            // 方向不一致（例如跨过相机中轴的 tile），退回逐条遍历
+            for (size_t i = begin; i < end; ++i)
+                hits.set(i, traverseRay(rays, i));
+            continue;
+        }
+
+        int n = end - begin;
+        std::vector<Ray> packetRays;
+        packetRays.reserve(n);
+        float tClosest[kPacketSize];
+        Intersection closest[kPacketSize];
+        for (int k = 0; k < n; ++k) {
+            packetRays.push_back(rays.ray(begin + k));
+            tClosest[k] = rays.tmax[begin + k];
+        }
+        float packetTMax = *std::max_element(tClosest, tClosest + n);
+
+        auto rayHitsNode = [&](const BVHBuildNode* node, int k) {
+            size_t i = begin + k;
+            return node->bounds.IntersectP(rays.ox[i], rays.oy[i], rays.oz[i],
+                                           rays.invdx[i], rays.invdy[i], rays.invdz[i], tClosest[k]);
+        };
+
+        // 栈中同时记录第一条可能命中该节点的光线，子节点从这条光线开始检查
+        std::pair<BVHBuildNode*, int> stack[128];
+        int sp = 0;
+        stack[sp++] = { root, 0 };
+        while (sp > 0) {
+            BVHBuildNode* node = stack[--sp].first;
+            int first = stack[sp].second;
+            // 整包一次性剔除，只有可能命中时才逐条检查
+            if (!packet.mayIntersect(node->bounds, packetTMax))
+                continue;
+            while (first < n && !rayHitsNode(node, first))
+                first++;
+            if (first == n)
+                continue;
+
+            if (node->left == nullptr && node->right == nullptr) {
+                for (int k = first; k < n; ++k) {
+                    if (k != first && !rayHitsNode(node, k))
+                        continue;
+                    Intersection inter = node->object->getIntersection(packetRays[k]);
+                    if (inter.happened && inter.distance < tClosest[k]) {
+                        closest[k] = inter;
+                        tClosest[k] = inter.distance;
+                    }
+                }
+                packetTMax = *std::max_element(tClosest, tClosest + n);
+                continue;
+            }
+            if (packet.dirIsNeg[node->splitAxis]) {
+                stack[sp++] = { node->left, first };
+                stack[sp++] = { node->right, first };
+            }
+            else {
+                stack[sp++] = { node->right, first };
+                stack[sp++] = { node->left, first };
+            }
+        }
+        for (int k = 0; k < n; ++k)
+            hits.set(begin + k, closest[k]);
+    }
+}
+
+// 遮挡查询：找到任意一个距离小于 maxDistance 的交点就返回，不需要最近交点，也不填写 Intersection
+bool BVHAccel::IntersectP(const Ray& ray, float maxDistance) const
+{
+    if (!root)
+        return false;
+    float ox = ray.origin.x, oy = ray.origin.y, oz = ray.origin.z;
+    float invx = ray.direction_inv.x, invy = ray.direction_inv.y, invz = ray.direction_inv.z;
+
+    BVHBuildNode* stack[128];
+    int sp = 0;
+    stack[sp++] = root;
+    while (sp > 0) {
+        BVHBuildNode* node = stack[--sp];
+        if (!node->bounds.IntersectP(ox, oy, oz, invx, invy, invz, maxDistance))
+            continue;
+        if (node->left == nullptr && node->right == nullptr) {
+            if (node->object->intersectP(ray, maxDistance))
+                return true;
+            continue;
+        }
+        stack[sp++] = node->right;
+        stack[sp++] = node->left;
+    }
+    return false;
+}
+
+// 批量遮挡查询：每条光线的最大距离取 rays.tmax；按包遍历，整包都被遮挡后提前结束
+void BVHAccel::IntersectP(const RayStream& rays, std::vector<uint8_t>& occluded) const
+{
+    occluded.assign(rays.size(), 0);
+    if (!root)
+        return;
+
+    for (size_t begin = 0; begin < rays.size(); begin += kPacketSize) {
+        size_t end = std::min(rays.size(), begin + (size_t)kPacketSize);
+        PacketInterval packet;
+        if (!packet.init(rays, begin, end)) {
+            for (size_t i = begin; i < end; ++i)
+                occluded[i] = IntersectP(rays.ray(i), rays.tmax[i]);
+            continue;
+        }
+
+        int n = end - begin;
+        int remaining = n;
+        float packetTMax = *std::max_element(rays.tmax.begin() + begin, rays.tmax.begin() + end);
+
+        // 已被遮挡的光线不再参与后续节点的测试
+        auto rayHitsNode = [&](const BVHBuildNode* node, int k) {
+            size_t i = begin + k;
+            return !occluded[i] &&
+                   node->bounds.IntersectP(rays.ox[i], rays.oy[i], rays.oz[i],
+                                           rays.invdx[i], rays.invdy[i], rays.invdz[i], rays.tmax[i]);
+        };
+
+        std::pair<BVHBuildNode*, int> stack[128];
+        int sp = 0;
+        stack[sp++] = { root, 0 };
+        while (sp > 0 && remaining > 0) {
+            BVHBuildNode* node = stack[--sp].first;
+            int first = stack[sp].second;
+            if (!packet.mayIntersect(node->bounds, packetTMax))
+                continue;
+            while (first < n && !rayHitsNode(node, first))
+                first++;
+            if (first == n)
+                continue;
+
+            if (node->left == nullptr && node->right == nullptr) {
+                for (int k = first; k < n; ++k) {
+                    if (k != first && !rayHitsNode(node, k))
+                        continue;
+                    if (node->object->intersectP(rays.ray(begin + k), rays.tmax[begin + k])) {
+                        occluded[begin + k] = 1;
+                        remaining--;
+                    }
+                }
+                continue;
+            }
+            stack[sp++] = { node->right, first };
+            stack[sp++] = { node->left, first };
+        }
+    }
+}
+
 Intersection BVHAccel::getIntersection(BVHBuildNode* node, const Ray& ray) const
 {
     /**
@@ -160,4 +619,4 @@ void BVHAccel::Sample(Intersection &pos, float &pdf){
     getSample(root, p, pos, pdf);
 
     pdf /= root->area;
-}
\ No newline at end of file
+}
@@ -13,11 +13,13 @@
 #include "Ray.hpp"
 #include "Bounds3.hpp"
 #include "Intersection.hpp"
+#include "RayStream.hpp"
 #include "Vector.hpp"
 
 struct BVHBuildNode;
 // BVHAccel Forward Declarations
 struct BVHPrimitiveInfo;
+struct MortonPrimitive;
 
 // BVHAccel Declarations
 inline int leafNodes, totalLeafNodes, totalPrimitives, interiorNodes;
@@ -25,7 +27,8 @@ class BVHAccel {
 
 public:
     // BVHAccel Public Types
-    enum class SplitMethod { NAIVE, SAH };
+    // LBVH: 按质心的 Morton 码并行基数排序后自顶向下划分，适合需要频繁重建的大网格
+    enum class SplitMethod { NAIVE, SAH, LBVH };
 
     // BVHAccel Public Methods
     BVHAccel(std::vector<Object*> p, int maxPrimsInNode = 1, SplitMethod splitMethod = SplitMethod::NAIVE);
@@ -33,20 +36,39 @@ public:
     ~BVHAccel();
 
     Intersection Intersect(const Ray &ray) const;
+    // 批量求交：按 SoA 读取光线，逐条做迭代遍历（近的子节点先访问，用当前最近交点裁剪）
+    void Intersect(const RayStream &rays, HitStream &hits) const;
+    // 光线包求交：每 kPacketSize 条光线为一包，用区间算术对整包做包围盒剔除；
+    // 适合同一 tile 的主光线、射向同一光源的阴影光线这类方向一致的光线
+    void IntersectPacket(const RayStream &rays, HitStream &hits) const;
+    static constexpr int kPacketSize = 64;
 
     // 最终获取场景中某个三角形和该光线的交点信息
     Intersection getIntersection(BVHBuildNode* node, const Ray& ray)const;
-    bool IntersectP(const Ray &ray) const;
+    // 遮挡查询（any-hit）：光线在 maxDistance 之内与任意图元相交即返回 true
+    bool IntersectP(const Ray &ray, float maxDistance) const;
+    // 批量遮挡查询，每条光线的最大距离为 rays.tmax，结果写入 occluded
+    void IntersectP(const RayStream &rays, std::vector<uint8_t> &occluded) const;
     BVHBuildNode* root;
 
     // BVHAccel Private Methods
-    BVHBuildNode* recursiveBuild(std::vector<Object*>objects);
+    // 在同一个 primitiveInfo 数组的 [start, end) 子区间上递归构建，子树之间按任务并行
+    BVHBuildNode* recursiveBuild(std::vector<BVHPrimitiveInfo>& primitiveInfo, int start, int end, int depth);
+    BVHBuildNode* buildLBVH(const std::vector<BVHPrimitiveInfo>& primitiveInfo);
+    BVHBuildNode* emitLBVH(const std::vector<MortonPrimitive>& mortonPrims, int start, int end, int bitIndex, int depth);
+    BVHBuildNode* createLeaf(Object* object);
+    BVHBuildNode* allocNode();
+    Intersection traverseRay(const RayStream& rays, size_t i) const;
 
     // BVHAccel Private Data
     const int maxPrimsInNode;
     const SplitMethod splitMethod;
     std::vector<Object*> primitives;
 
+    // 所有节点预先分配在一块连续内存中（n 个叶子的二叉树共 2n-1 个节点），析构时一并释放
+    std::vector<BVHBuildNode> nodes;
+    std::atomic<int> totalNodes{0};
+
     void getSample(BVHBuildNode* node, float p, Intersection &pos, float &pdf);
     void Sample(Intersection &pos, float &pdf);
 };
@@ -91,6 +91,9 @@ class Bounds3
     //射线和bounds是否有相交
     inline bool IntersectP(const Ray& ray, const Vector3f& invDir,
                            const std::array<int, 3>& dirisNeg) const;
+    //SoA 光线批使用的版本：直接传入 float 分量，只在 [0, tMax] 内判断相交
+    inline bool IntersectP(float ox, float oy, float oz,
+                           float invx, float invy, float invz, float tMax) const;
 };
 
 
@@ -119,6 +122,17 @@ inline bool Bounds3::IntersectP(const Ray& ray, const Vector3f& invDir, const st
 	return tEnter <= tExit && tExit >= 0;
 }
 
+inline bool Bounds3::IntersectP(float ox, float oy, float oz,
+                                float invx, float invy, float invz, float tMax) const
+{
+    float tx0 = (pMin.x - ox) * invx, tx1 = (pMax.x - ox) * invx;
+    float ty0 = (pMin.y - oy) * invy, ty1 = (pMax.y - oy) * invy;
+    float tz0 = (pMin.z - oz) * invz, tz1 = (pMax.z - oz) * invz;
+    float tEnter = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+    float tExit = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+    return tEnter <= tExit;
+}
+
 //并集
 inline Bounds3 Union(const Bounds3& b1, const Bounds3& b2)
 {
@@ -0,0 +1,150 @@
+//
+// SoA 光线批 / 交点批，供批量求交（主光线、阴影光线）使用
+//
+
+#ifndef RAYTRACING_RAYSTREAM_H
+#define RAYTRACING_RAYSTREAM_H
+
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "global.hpp"
+#include "Ray.hpp"
+#include "Intersection.hpp"
+
+// 按 Alignment 字节对齐分配，保证每个分量数组的起始地址可以直接做向量化加载
+template <typename T, size_t Alignment = 32>
+struct AlignedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, size_t)
+    {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// 按 order 重排数组：重排后的第 k 个元素是原来的第 order[k] 个
+template <typename V>
+void gather(V& v, const std::vector<uint32_t>& order)
+{
+    V tmp(order.size());
+    for (size_t k = 0; k < order.size(); ++k)
+        tmp[k] = v[order[k]];
+    v.swap(tmp);
+}
+
+// 光线批：起点、方向、方向倒数、tMax 各自存成一个连续的 float 数组
+struct RayStream {
+    AlignedVector<float> ox, oy, oz;
+    AlignedVector<float> dx, dy, dz;
+    AlignedVector<float> invdx, invdy, invdz;
+    AlignedVector<float> tmax;
+
+    size_t size() const { return ox.size(); }
+    bool empty() const { return ox.empty(); }
+
+    void reserve(size_t n)
+    {
+        for (auto* a : arrays()) a->reserve(n);
+    }
+
+    void clear()
+    {
+        for (auto* a : arrays()) a->clear();
+    }
+
+    void push(const Vector3f& origin, const Vector3f& dir, float tMax = kInfinity)
+    {
+        ox.push_back(origin.x); oy.push_back(origin.y); oz.push_back(origin.z);
+        dx.push_back(dir.x); dy.push_back(dir.y); dz.push_back(dir.z);
+        invdx.push_back(1.f / dir.x); invdy.push_back(1.f / dir.y); invdz.push_back(1.f / dir.z);
+        tmax.push_back(tMax);
+    }
+
+    void push(const Ray& ray) { push(ray.origin, ray.direction, ray.t_max); }
+
+    void reorder(const std::vector<uint32_t>& order)
+    {
+        for (auto* a : arrays()) gather(*a, order);
+    }
+
+    Vector3f origin(size_t i) const { return Vector3f(ox[i], oy[i], oz[i]); }
+    Vector3f direction(size_t i) const { return Vector3f(dx[i], dy[i], dz[i]); }
+
+    // 取出第 i 条光线（给只接受 Ray 的图元求交接口使用）
+    Ray ray(size_t i) const
+    {
+        Ray r(origin(i), direction(i));
+        r.t_max = tmax[i];
+        return r;
+    }
+
+private:
+    std::vector<AlignedVector<float>*> arrays()
+    {
+        return { &ox, &oy, &oz, &dx, &dy, &dz, &invdx, &invdy, &invdz, &tmax };
+    }
+};
+
+// 交点批：与 RayStream 一一对应
+struct HitStream {
+    std::vector<uint8_t> happened;
+    AlignedVector<float> t;
+    AlignedVector<float> px, py, pz;
+    AlignedVector<float> nx, ny, nz;
+    std::vector<Object*> obj;
+    std::vector<Material*> m;
+
+    size_t size() const { return happened.size(); }
+
+    void resize(size_t n)
+    {
+        happened.assign(n, 0);
+        t.assign(n, kInfinity);
+        px.resize(n); py.resize(n); pz.resize(n);
+        nx.resize(n); ny.resize(n); nz.resize(n);
+        obj.assign(n, nullptr);
+        m.assign(n, nullptr);
+    }
+
+    void set(size_t i, const Intersection& inter)
+    {
+        happened[i] = inter.happened;
+        if (!inter.happened) return;
+        t[i] = inter.distance;
+        px[i] = inter.coords.x; py[i] = inter.coords.y; pz[i] = inter.coords.z;
+        nx[i] = inter.normal.x; ny[i] = inter.normal.y; nz[i] = inter.normal.z;
+        obj[i] = inter.obj;
+        m[i] = inter.m;
+    }
+
+    // 还原成 Intersection，方便复用现有的着色代码
+    Intersection get(size_t i) const
+    {
+        Intersection inter;
+        inter.happened = happened[i];
+        if (!inter.happened) return inter;
+        inter.distance = t[i];
+        inter.coords = Vector3f(px[i], py[i], pz[i]);
+        inter.normal = Vector3f(nx[i], ny[i], nz[i]);
+        inter.obj = obj[i];
+        inter.m = m[i];
+        return inter;
+    }
+};
+
+#endif //RAYTRACING_RAYSTREAM_H
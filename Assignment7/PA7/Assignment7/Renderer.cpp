@@ -1,5 +1,7 @@
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 
 std::mutex mutex_ins;
 
@@ -22,42 +24,149 @@ const float EPSILON = 0.00001;
 // framebuffer is saved to a file.
 void Renderer::Render(const Scene& scene)
 {
-    std::vector<Vector3f> framebuffer(scene.width * scene.height);
+	AccumulationBuffer accum(scene.width, scene.height);
+	if (!scene.checkpoint.empty() && accum.load(scene.checkpoint)) {
+		std::cout << "Resumed from " << scene.checkpoint << ": " << accum.minSamples() << " spp\n";
+	}
+
+	// 射线数量
+	int spp = scene.spp;
+	// 自适应采样要在两遍之间判断收敛：没给每遍的采样数时按 adaptiveMinSpp 一遍，而不是一遍采完 spp
+	int passSpp = scene.sppPerPass > 0 ? scene.sppPerPass
+		: scene.adaptiveThreshold > 0 ? scene.adaptiveMinSpp : spp;
+	passSpp = std::min(passSpp, spp);
+	std::cout << "SPP: " << spp << " (" << passSpp << " per pass)\n";
+
+	auto start = std::chrono::steady_clock::now();
+	double lastPass = 0;
+	int pass = 0;
+	std::vector<uint8_t> active;
+	while (true) {
+		// 自适应采样：已经收敛的像素不再参与后面的轮次
+		int activePixels = accum.markActive(spp, scene.adaptiveMinSpp, scene.adaptiveThreshold, active);
+		if (activePixels == 0) break;
+		// 方差至少要两个样本才有意义
+		if (scene.targetVariance > 0 && accum.minSamples() >= 2 && accum.averageVariance() <= scene.targetVariance) {
+			std::cout << "Target variance reached\n";
+			break;
+		}
+		// 按上一遍的耗时估计下一遍，放不进预算就停；没有任何样本时至少渲染一遍
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (scene.timeBudget > 0 && accum.totalSamples() > 0 && elapsed + lastPass > scene.timeBudget) {
+			std::cout << "Time budget reached\n";
+			break;
+		}
+
+		auto passStart = std::chrono::steady_clock::now();
+		RenderPass(scene, accum, passSpp, active);
+		lastPass = std::chrono::duration<double>(std::chrono::steady_clock::now() - passStart).count();
+		pass++;
+
+		std::cout << "\nPass " << pass << ": " << activePixels << " pixels, " << accum.minSamples() << " spp min, "
+		          << lastPass << " s, variance " << accum.averageVariance() << "\n";
+		if (!scene.checkpoint.empty() && !accum.save(scene.checkpoint))
+			std::cerr << "Cannot write checkpoint " << scene.checkpoint << "\n";
+	}
+
+	int pixels = scene.width * scene.height;
+	std::cout << "Samples: " << accum.totalSamples() << " (" << float(accum.totalSamples()) / pixels
+	          << " per pixel on average, uniform " << spp << ")\n";
+
+    // save framebuffer to file
+    if (!accum.writeImage(scene.output))
+        std::cerr << "Cannot open " << scene.output << " for writing\n";
+    if (!scene.sampleMap.empty() && !accum.writeSampleMap(scene.sampleMap))
+        std::cerr << "Cannot open " << scene.sampleMap << " for writing\n";
+}
 
+void Renderer::RenderPass(const Scene& scene, AccumulationBuffer& accum, int spp, const std::vector<uint8_t>& active)
+{
     float scale = tan(deg2rad(scene.fov * 0.5));
     float imageAspectRatio = scene.width / (float)scene.height;
-    Vector3f eye_pos(278, 273, -800);
-    int m = 0;
+    Vector3f eye_pos = scene.eye_pos;
 
-	// 射线数量
-	int spp = 1;
-	std::cout << "SPP: " << spp << "\n";
+	std::atomic<int> process(0);
+
+	// Random 不绑定采样流，get_random_float() 仍是独立随机数
+	Sampler sampler(scene.sampler, scene.spp);
+	const Sampler* pathSampler = scene.sampler == SamplerType::Random ? nullptr : &sampler;
 
-	int process = 0;
+	// 每个线程负责的块再按 kTile x kTile 的小 tile 处理：一个 tile 的主光线组成一个光线包，
+	// 方向相近，整包做 BVH 剔除
+	constexpr uint32_t kTile = 8;
+
+	// 波前模式下每个线程攒够这么多条路径再一起追踪
+	constexpr size_t kWavefrontBatch = 4096;
+	bool wavefront = scene.integrator == IntegratorType::Wavefront;
 
 	// 创造匿名函数，为不同线程划分不同块
 	auto castRayMultiThreading = [&](uint32_t rowStart, uint32_t rowEnd, uint32_t colStart, uint32_t colEnd)
 	{
-		for (uint32_t j = rowStart; j < rowEnd; ++j) {
-			int m = j * scene.width + colStart;
-			for (uint32_t i = colStart; i < colEnd; ++i) {
-				// generate primary ray direction
-				float x = (2 * (i + 0.5) / (float)scene.width - 1) * imageAspectRatio * scale;
-				float y = (1 - 2 * (j + 0.5) / (float)scene.height) * scale;
-				Vector3f dir = normalize(Vector3f(-x, y, 1));//算出光线
-
+		RayStream rays;
+		std::vector<Vector3f> colors;
+		std::vector<int> pixels;
+		std::vector<SampleStream> streams;
+		uint32_t base[kTile * kTile];//tile 内每个像素在本遍开始时已有的样本数
+
+		// 追踪已生成的光线，结果累加到对应像素
+		auto flush = [&]() {
+			if (pixels.empty())
+				return;
+			if (wavefront)
+				scene.castRayWavefront(rays, colors, &streams);
+			else
+				scene.castRayPacket(rays, colors, &streams);//光线追踪
+			for (size_t r = 0; r < pixels.size(); ++r)
+				accum.add(pixels[r], colors[r]);
+			rays.clear();
+			pixels.clear();
+			streams.clear();
+		};
+
+		for (uint32_t tj = rowStart; tj < rowEnd; tj += kTile) {
+			uint32_t tjEnd = std::min(tj + kTile, rowEnd);
+			for (uint32_t ti = colStart; ti < colEnd; ti += kTile) {
+				uint32_t tiEnd = std::min(ti + kTile, colEnd);
+				for (uint32_t j = tj; j < tjEnd; ++j)
+					for (uint32_t i = ti; i < tiEnd; ++i)
+						base[(j - tj) * kTile + (i - ti)] = accum.samples(j * scene.width + i);
+
+				// 只追踪本轮需要采样、且还没到 scene.spp 的像素；tile 内没有像素时提前结束
 				for (int k = 0; k < spp; k++) {
-					//对场景中的每一个像素生成一道从视点发出感受光线（路径追踪）
-					framebuffer[m] += scene.castRay(Ray(eye_pos, dir), 0) / spp;//光线追踪
+					size_t generated = pixels.size();
+					for (uint32_t j = tj; j < tjEnd; ++j) {
+						for (uint32_t i = ti; i < tiEnd; ++i) {
+							int pixel = j * scene.width + i;
+							// 样本序号接着该像素已有的样本数，从检查点继续时序列也能接上
+							uint32_t index = base[(j - tj) * kTile + (i - ti)] + k;
+							if (!active[pixel] || index >= (uint32_t)scene.spp)
+								continue;
+							streams.push_back(SampleStream{pathSampler, (uint32_t)pixel, index, 0});
+							SampleStreamScope bind(&streams.back());
+							// 维度 0、1：像素内的抖动
+							float jx = get_random_float(), jy = get_random_float();
+							// generate primary ray direction
+							float x = (2 * (i + jx) / (float)scene.width - 1) * imageAspectRatio * scale;
+							float y = (1 - 2 * (j + jy) / (float)scene.height) * scale;
+							rays.push(eye_pos, normalize(Vector3f(-x, y, 1)));//算出光线
+							pixels.push_back(pixel);
+						}
+					}
+					if (pixels.size() == generated)
+						break;
+
+					// 光线包模式：tile 中每个像素的一个样本组成一包，立即追踪；波前模式：攒够一批再追踪
+					if (!wavefront || pixels.size() >= kWavefrontBatch)
+						flush();
 				}
-				m++;
-				process++;
+				process += (tjEnd - tj) * (tiEnd - ti);
 			}
 
 			// 互斥锁，用于打印处理进程
 			std::lock_guard<std::mutex> g1(mutex_ins);
 			UpdateProgress(1.0*process / scene.width / scene.height);
 		}
+		flush();
 	};
 
 	// 分块计算光线追踪
@@ -66,33 +175,21 @@ void Renderer::Render(const Scene& scene)
 	constexpr int by = 5;
 	std::thread th[bx * by];
 
-	int strideX = (scene.width + 1) / bx;
-	int strideY = (scene.height + 1) / by;
+	// 向上取整，保证块数不超过 bx * by（非正方形图像也一样）
+	int strideX = (scene.width + bx - 1) / bx;
+	int strideY = (scene.height + by - 1) / by;
 	// 分块计算光线追踪
-	for (int i = 0; i < scene.height; i += strideX)
+	for (int i = 0; i < scene.height; i += strideY)
 	{
-		for (int j = 0; j < scene.width; j += strideY)
+		for (int j = 0; j < scene.width; j += strideX)
 		{
-			th[id] = std::thread(castRayMultiThreading, i, std::min(i + strideX, scene.height), j, std::min(j + strideY, scene.width));
+			th[id] = std::thread(castRayMultiThreading, i, std::min(i + strideY, scene.height), j, std::min(j + strideX, scene.width));
 			id++;
 		}
 	}
 
-	for (int i = 0; i < bx*by; i++) th[i].join();
+	for (int i = 0; i < id; i++) th[i].join();
 
 	//进度条
 	UpdateProgress(1.f);
-
-
-    // save framebuffer to file
-    FILE* fp = fopen("binary.ppm", "wb");
-    (void)fprintf(fp, "P6\n%d %d\n255\n", scene.width, scene.height);
-    for (auto i = 0; i < scene.height * scene.width; ++i) {
-        static unsigned char color[3];
-        color[0] = (unsigned char)(255 * std::pow(clamp(0, 1, framebuffer[i].x), 0.6f));
-        color[1] = (unsigned char)(255 * std::pow(clamp(0, 1, framebuffer[i].y), 0.6f));
-        color[2] = (unsigned char)(255 * std::pow(clamp(0, 1, framebuffer[i].z), 0.6f));
-        fwrite(color, 1, 3, fp);
-    }
-    fclose(fp);    
 }
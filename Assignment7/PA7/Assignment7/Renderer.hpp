@@ -2,6 +2,7 @@
 // Created by goksu on 2/25/20.
 //
 #include "Scene.hpp"
+#include "AccumulationBuffer.hpp"
 
 #pragma once
 struct hit_payload
@@ -15,7 +16,13 @@ struct hit_payload
 class Renderer
 {
 public:
+    // 渐进式渲染：每一遍给需要采样的像素加 scene.sppPerPass 个样本，直到所有像素达到 scene.spp、
+    // 用完 scene.timeBudget 或平均方差低于 scene.targetVariance；scene.adaptiveThreshold 大于 0 时
+    // 相对误差已经低于阈值的像素不再采样；
+    // scene.checkpoint 非空时每一遍结束后写检查点，开始时若检查点存在则从它继续
     void Render(const Scene& scene);
 
 private:
+    // 一遍渲染：active 标记的每个像素追踪 spp 条路径（不超过 scene.spp），累加到 accum
+    void RenderPass(const Scene& scene, AccumulationBuffer& accum, int spp, const std::vector<uint8_t>& active);
 };
@@ -0,0 +1,196 @@
+//
+// 可替换的采样器：路径追踪中的随机数按 (像素, 第几个样本, 维度) 取值
+//
+// 每条路径按使用顺序依次消耗维度：0、1 为像素内的抖动，之后是光源选择、光源上的点、
+// 俄罗斯轮盘赌、材质采样……。绑定到当前线程后，get_random_float() 从这里取数，
+// 所以 Material::sample、Triangle::Sample、BVHAccel::Sample 等调用点不需要改动
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+enum class SamplerType
+{
+    Random,     // 独立均匀随机数（白噪声），不绑定采样流
+    Stratified, // 每个维度分 spp 层，层的顺序按像素和维度打乱
+    Sobol       // Owen 扰乱的 Sobol 序列（Burley 2020，4 维一组，组之间打乱样本顺序）
+};
+
+namespace sampling
+{
+
+inline uint32_t hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+inline uint32_t hashCombine(uint32_t seed, uint32_t v)
+{
+    return seed ^ (hash(v) + 0x9e3779b9U + (seed << 6) + (seed >> 2));
+}
+
+inline uint32_t reverseBits(uint32_t x)
+{
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ffU) << 8) | ((x & 0xff00ff00U) >> 8);
+    x = ((x & 0x0f0f0f0fU) << 4) | ((x & 0xf0f0f0f0U) >> 4);
+    x = ((x & 0x33333333U) << 2) | ((x & 0xccccccccU) >> 2);
+    x = ((x & 0x55555555U) << 1) | ((x & 0xaaaaaaaaU) >> 1);
+    return x;
+}
+
+// 对位反转后的数做 Laine-Karras 置换，等价于对原数做嵌套均匀扰乱（Owen scrambling）
+inline uint32_t nestedUniformScramble(uint32_t x, uint32_t seed)
+{
+    x = reverseBits(x);
+    x ^= x * 0x3d20adeaU;
+    x += seed;
+    x *= (seed >> 16) | 1;
+    x ^= x * 0x05526c56U;
+    x ^= x * 0x53a22864U;
+    return reverseBits(x);
+}
+
+// Sobol 序列前 4 维的生成矩阵（Joe-Kuo 方向数）
+inline const uint32_t (&sobolMatrices())[4][32]
+{
+    static const auto matrices = [] {
+        struct { uint32_t v[4][32]; } m;
+        const uint32_t s[4] = {0, 1, 2, 3}, a[4] = {0, 0, 1, 1};
+        const uint32_t init[4][3] = {{0, 0, 0}, {1, 0, 0}, {1, 3, 0}, {1, 3, 1}};
+        for (int i = 0; i < 32; ++i)
+            m.v[0][i] = 1U << (31 - i);
+        for (int d = 1; d < 4; ++d) {
+            for (uint32_t i = 0; i < 32; ++i) {
+                if (i < s[d]) {
+                    m.v[d][i] = init[d][i] << (31 - i);
+                    continue;
+                }
+                uint32_t v = m.v[d][i - s[d]] ^ (m.v[d][i - s[d]] >> s[d]);
+                for (uint32_t k = 1; k < s[d]; ++k)
+                    if ((a[d] >> (s[d] - 1 - k)) & 1)
+                        v ^= m.v[d][i - k];
+                m.v[d][i] = v;
+            }
+        }
+        return m;
+    }();
+    return matrices.v;
+}
+
+// 扰乱后的序号通常 32 位都有值，只遍历为 1 的位
+inline uint32_t sobol(uint32_t index, const uint32_t* v)
+{
+    uint32_t x = 0;
+    for (; index; index &= index - 1)
+        x ^= v[__builtin_ctz(index)];
+    return x;
+}
+
+// Kensler 的可变长度置换：把 i ∈ [0, l) 映射到 [0, l) 的一个伪随机排列
+inline uint32_t permute(uint32_t i, uint32_t l, uint32_t p)
+{
+    uint32_t w = l - 1;
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+    do {
+        i ^= p;
+        i *= 0xe170893dU;
+        i ^= p >> 16;
+        i ^= (i & w) >> 4;
+        i ^= p >> 8;
+        i *= 0x0929eb3fU;
+        i ^= p >> 23;
+        i ^= (i & w) >> 1;
+        i *= 1 | p >> 27;
+        i *= 0x6935fa69U;
+        i ^= (i & w) >> 11;
+        i *= 0x74dcb303U;
+        i ^= (i & w) >> 2;
+        i *= 0x9e501cc3U;
+        i ^= (i & w) >> 2;
+        i *= 0xc860a3dfU;
+        i &= w;
+        i ^= i >> 5;
+    } while (i >= l);
+    return (i + p) % l;
+}
+
+// 32 位整数 -> [0, 1)，保证不会舍入到 1
+inline float toUnitFloat(uint32_t x)
+{
+    return std::fmin(x * 0x1p-32f, 0x1.fffffep-1f);
+}
+
+} // namespace sampling
+
+class Sampler
+{
+public:
+    Sampler(SamplerType t, uint32_t samplesPerPixel)
+        : type(t), spp(samplesPerPixel > 0 ? samplesPerPixel : 1), matrices(sampling::sobolMatrices())
+    {}
+
+    float get(uint32_t pixel, uint32_t index, uint32_t dim) const
+    {
+        using namespace sampling;
+        uint32_t seed = hash(pixel);
+        if (type == SamplerType::Sobol) {
+            uint32_t groupSeed = hashCombine(seed, dim / 4);
+            uint32_t shuffled = nestedUniformScramble(index, groupSeed);
+            uint32_t x = sobol(shuffled, matrices[dim % 4]);
+            return toUnitFloat(nestedUniformScramble(x, hashCombine(groupSeed, dim % 4 + 1)));
+        }
+        // Stratified：第 index / spp 轮换一个排列，超过 spp 个样本（自适应采样）时仍然分层
+        uint32_t dimSeed = hashCombine(hashCombine(seed, dim), index / spp);
+        uint32_t stratum = permute(index % spp, spp, dimSeed);
+        float jitter = toUnitFloat(hash(hashCombine(dimSeed, index)));
+        return std::fmin((stratum + jitter) / spp, 0x1.fffffep-1f);
+    }
+
+    SamplerType type;
+    uint32_t spp;
+
+private:
+    const uint32_t (&matrices)[4][32];
+};
+
+// 一条路径的采样状态：sampler 为空时 get_random_float() 退回独立随机数
+struct SampleStream
+{
+    const Sampler* sampler = nullptr;
+    uint32_t pixel = 0, index = 0, dimension = 0;
+
+    float next() { return sampler->get(pixel, index, dimension++); }
+};
+
+// 当前线程正在使用的采样流
+inline SampleStream*& currentSampleStream()
+{
+    static thread_local SampleStream* stream = nullptr;
+    return stream;
+}
+
+// 在作用域内把 stream 绑定到当前线程，结束时恢复原来的绑定
+class SampleStreamScope
+{
+public:
+    explicit SampleStreamScope(SampleStream* stream) : previous(currentSampleStream())
+    {
+        currentSampleStream() = (stream && stream->sampler) ? stream : nullptr;
+    }
+    ~SampleStreamScope() { currentSampleStream() = previous; }
+
+private:
+    SampleStream* previous;
+};
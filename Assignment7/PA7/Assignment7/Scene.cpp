@@ -2,11 +2,13 @@
 // Created by Göksu Güvendiren on 2019-05-14.
 //
 
+#include <algorithm>
 #include "Scene.hpp"
 
 
 void Scene::buildBVH() {
     printf(" - Generating BVH...\n\n");
+    delete this->bvh;
     this->bvh = new BVHAccel(objects, 1, BVHAccel::SplitMethod::NAIVE);
 }
 
@@ -15,6 +17,26 @@ Intersection Scene::intersect(const Ray &ray) const
     return this->bvh->Intersect(ray);
 }
 
+void Scene::intersect(const RayStream &rays, HitStream &hits) const
+{
+    this->bvh->Intersect(rays, hits);
+}
+
+void Scene::intersectPacket(const RayStream &rays, HitStream &hits) const
+{
+    this->bvh->IntersectPacket(rays, hits);
+}
+
+bool Scene::intersectP(const Ray &ray, float maxDistance) const
+{
+    return this->bvh->IntersectP(ray, maxDistance);
+}
+
+void Scene::intersectP(const RayStream &rays, std::vector<uint8_t> &occluded) const
+{
+    this->bvh->IntersectP(rays, occluded);
+}
+
 //sampleLight : 得到lightInter（场景中光源区域的任意一点），pdf（该光源的密度）
 void Scene::sampleLight(Intersection &pos, float &pdf) const
 {
@@ -39,6 +61,7 @@ void Scene::sampleLight(Intersection &pos, float &pdf) const
             if (p <= emit_area_sum){//按光源面积比例，随机找到一个光源面，再在这个光源面中找到一个点
 				//这里调用的是 MeshTriangle 中的 Sample
                 objects[k]->Sample(pos, pdf);//pos为该光源面中随机找到的一个点，pdf为 1/该模型的面积
+                pos.obj = objects[k];//记录采样到的光源物体，阴影光线按它分组
                 break;
             }
         }
@@ -56,8 +79,8 @@ Vector3f Scene::castRay(const Ray &ray, int depth) const
 	 		如果射线第一次打到光源，则直接返回光源颜色。
 			如果射线打到光源，但不是该像素的直接光照，则返回0。该问题在交点为物体时求解。
 	 * 3.如果交点为物体
-	 		生成一条由该物体指向随机生成的光源的一条光线，与场景求交，交点为light2obj
-			如果该光线击中光源，计算直接光照值
+	 		生成一条由该物体指向随机生成的光源的一条光线，做遮挡查询
+			如果该光线在到达光源之前没有被遮挡，计算直接光照值
 			（递归）光线是否继续弹射，计算间接光照？（俄罗斯轮盘赌）
 	 * 4.返回得到的光线值
 	 */
@@ -79,9 +102,6 @@ Vector3f Scene::castRay(const Ray &ray, int depth) const
 		}
 
 		// 3.
-		Vector3f L_dir(0, 0, 0);//当前：直接光照
-		Vector3f L_indir(0, 0, 0);//当前：间接光照(递归结果)
-
 		// 随机生成光线 lightInter
 		// 随机 sample 灯光，用该 sample 的结果判断射线是否击中光源
 		// lightInter（场景中光源区域的任意一点），pdf（该光源的概率密度）
@@ -89,56 +109,116 @@ Vector3f Scene::castRay(const Ray &ray, int depth) const
 		float pdf_light = 0.0f;
 		sampleLight(lightInter, pdf_light);
 
-		// 物体表面法线
-		auto& N = inter.normal;
-		// 灯光表面法线
-		auto& NN = lightInter.normal;
+		Vector3f diff = lightInter.coords - inter.coords;
+		Ray light(inter.coords, diff.normalized());
+		// 遮挡查询：只关心到光源之前有没有交点，找到一个就返回
+		bool occluded = intersectP(light, diff.norm() - kShadowEpsilon);
 
-		auto& objPos = inter.coords;
-		auto& lightPos = lightInter.coords;
+		//最后返回直接光照和间接光照
+		return directLight(ray.direction, inter, lightInter, pdf_light, occluded)
+			+ indirectLight(ray.direction, inter, depth);
+	}
 
-		auto diff = lightPos - objPos;
-		auto lightDir = diff.normalized();
-		float lightDistance = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
+	//如果光线与场景无交点sample
+	return Vector3f(0, 0, 0);
+}
 
-		Ray light(objPos, lightDir);
-		// 与场景求交，交点为light2obj 
-		Intersection light2obj = intersect(light);
+Vector3f Scene::directLight(const Vector3f &wo, const Intersection &inter, const Intersection &lightInter,
+                            float pdf_light, bool occluded) const
+{
+	// 物体表面法线
+	auto& N = inter.normal;
+	// 灯光表面法线
+	auto& NN = lightInter.normal;
 
+	auto& objPos = inter.coords;
+	auto& lightPos = lightInter.coords;
 
-		// 如果该光线击中光源（及该光源可以直接照射到该点），计算直接光照值
-		if (light2obj.happened && (light2obj.coords - lightPos).norm() < 1e-2)
-		{
-			//获取改材质的brdf，这里的 BRDF 为漫反射（brdf=Kd/pi）
-			Vector3f f_r = inter.m->eval(ray.direction, lightDir, N);
-			
-			//直接光照光 = 光源光 * brdf * 光线和物体角度衰减 * 光线和光源法线角度衰减 / 光线距离 / 该点的概率密度（1/该光源的面积）
-			L_dir = lightInter.emit * f_r * dotProduct(lightDir, N) * dotProduct(-lightDir, NN) / lightDistance / pdf_light;
-		}
+	auto diff = lightPos - objPos;
+	auto lightDir = diff.normalized();
+	float lightDistance = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
 
-		//俄罗斯轮盘赌，确定是否继续弹射光线
-		if (get_random_float() < RussianRoulette)
-		{
-			//获取半平面上的随机弹射方向
-			Vector3f nextDir = inter.m->sample(ray.direction, N).normalized();
-			//定义弹射光线
-			Ray nextRay(objPos, nextDir);
-			//获取相交点
-			Intersection nextInter = intersect(nextRay);
-			//如果有相交，且是与物体相交
-			if (nextInter.happened && !nextInter.m->hasEmission())
-			{
-				//该点间接光= 弹射点反射光 * brdf * 角度衰减 / pdf(认为该点四面八方都接收到了该方向的光强，为1/(2*pi)) / 俄罗斯轮盘赌值(强度矫正值)
-				float pdf = inter.m->pdf(ray.direction, nextDir, N);
-				Vector3f f_r = inter.m->eval(ray.direction, nextDir, N);
-				L_indir = castRay(nextRay, depth + 1) * f_r * dotProduct(nextDir, N) / pdf / RussianRoulette;
-			}
-		}
+	// 如果该光线没有被遮挡（及该光源可以直接照射到该点），且光源正面朝向该点，计算直接光照值
+	if (!occluded && dotProduct(lightDir, N) > 0 && dotProduct(-lightDir, NN) > 0)
+	{
+		//获取改材质的brdf，这里的 BRDF 为漫反射（brdf=Kd/pi）
+		Vector3f f_r = inter.m->eval(wo, lightDir, N);
 
-		//最后返回直接光照和间接光照
-		return L_dir + L_indir;
+		//直接光照光 = 光源光 * brdf * 光线和物体角度衰减 * 光线和光源法线角度衰减 / 光线距离 / 该点的概率密度（1/该光源的面积）
+		return lightInter.emit * f_r * dotProduct(lightDir, N) * dotProduct(-lightDir, NN) / lightDistance / pdf_light;
 	}
+	return Vector3f(0, 0, 0);
+}
 
-	//如果光线与场景无交点sample
+Vector3f Scene::indirectLight(const Vector3f &wo, const Intersection &inter, int depth) const
+{
+	auto& N = inter.normal;
+	//俄罗斯轮盘赌，确定是否继续弹射光线
+	if (get_random_float() < RussianRoulette)
+	{
+		//获取半平面上的随机弹射方向
+		Vector3f nextDir = inter.m->sample(wo, N).normalized();
+		//定义弹射光线
+		Ray nextRay(inter.coords, nextDir);
+		//获取相交点
+		Intersection nextInter = intersect(nextRay);
+		//如果有相交，且是与物体相交
+		if (nextInter.happened && !nextInter.m->hasEmission())
+		{
+			//该点间接光= 弹射点反射光 * brdf * 角度衰减 / pdf(认为该点四面八方都接收到了该方向的光强，为1/(2*pi)) / 俄罗斯轮盘赌值(强度矫正值)
+			float pdf = inter.m->pdf(wo, nextDir, N);
+			Vector3f f_r = inter.m->eval(wo, nextDir, N);
+			return castRay(nextRay, depth + 1) * f_r * dotProduct(nextDir, N) / pdf / RussianRoulette;
+		}
+	}
 	return Vector3f(0, 0, 0);
 }
+
+void Scene::castRayPacket(const RayStream &rays, std::vector<Vector3f> &colors,
+                          std::vector<SampleStream> *streams) const
+{
+	size_t n = rays.size();
+	colors.assign(n, Vector3f(0, 0, 0));
+
+	// 1. 主光线整包求交
+	HitStream hits;
+	intersectPacket(rays, hits);
+
+	// 2. 每个非光源着色点采样一个光源点；阴影光线按采样到的光源物体分组，
+	//    同一组光线指向同一块光源，方向一致性好，整包求交时剔除效率更高
+	std::vector<Intersection> inters(n), lightInters(n);
+	std::vector<float> pdfs(n, 0.0f);
+	std::vector<size_t> shading;
+	for (size_t i = 0; i < n; ++i) {
+		if (!hits.happened[i]) continue;
+		inters[i] = hits.get(i);
+		if (inters[i].m->hasEmission()) {
+			colors[i] = inters[i].m->getEmission();
+			continue;
+		}
+		SampleStreamScope bind(streams ? &(*streams)[i] : nullptr);
+		sampleLight(lightInters[i], pdfs[i]);
+		shading.push_back(i);
+	}
+	std::stable_sort(shading.begin(), shading.end(), [&](size_t a, size_t b) {
+		return lightInters[a].obj < lightInters[b].obj;
+	});
+
+	RayStream shadowRays;
+	shadowRays.reserve(shading.size());
+	for (size_t i : shading) {
+		Vector3f diff = lightInters[i].coords - inters[i].coords;
+		shadowRays.push(inters[i].coords, diff.normalized(), diff.norm() - kShadowEpsilon);
+	}
+	std::vector<uint8_t> occluded;
+	intersectP(shadowRays, occluded);
+
+	// 3. 直接光照用分组求交的结果，间接光照逐条递归
+	for (size_t k = 0; k < shading.size(); ++k) {
+		size_t i = shading[k];
+		Vector3f wo = rays.direction(i);
+		SampleStreamScope bind(streams ? &(*streams)[i] : nullptr);
+		colors[i] = directLight(wo, inters[i], lightInters[i], pdfs[i], occluded[k])
+			+ indirectLight(wo, inters[i], 0);
+	}
+}
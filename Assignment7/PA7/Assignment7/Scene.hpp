@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include "Vector.hpp"
 #include "Object.hpp"
@@ -12,6 +13,8 @@
 #include "BVH.hpp"
 #include "Ray.hpp"
 
+// 路径追踪的执行方式：Packet 为按 tile 的光线包 + 逐条递归；Wavefront 为整批按阶段推进
+enum class IntegratorType { Packet, Wavefront };
 
 class Scene
 {
@@ -23,9 +26,25 @@ public:
     Vector3f backgroundColor = Vector3f(0.235294, 0.67451, 0.843137);
     int maxDepth = 1;
     float RussianRoulette = 0.9;
+    Vector3f eye_pos = Vector3f(278, 273, -800);//视点位置，看向 +z
+    int spp = 1;//每个像素的采样数
+    std::string output = "binary.ppm";//输出文件
+    // 渐进式渲染
+    int sppPerPass = 0;//每一遍每个像素的采样数，0 表示一遍采完 spp（开启自适应采样时为 adaptiveMinSpp）
+    double timeBudget = 0;//时间预算（秒），预计下一遍会超时就停止，0 表示不限
+    float targetVariance = 0;//像素均值的平均方差低于该值时停止，0 表示不检查
+    std::string checkpoint;//累积缓冲的检查点文件，空表示不保存
+    // 自适应采样
+    float adaptiveThreshold = 0;//像素相对误差低于该值后不再采样，0 表示关闭
+    int adaptiveMinSpp = 4;//每个像素至少的采样数，之后才用方差判断是否收敛
+    std::string sampleMap;//采样数热力图输出文件，空表示不输出
+    SamplerType sampler = SamplerType::Random;//路径追踪使用的采样器
+    IntegratorType integrator = IntegratorType::Packet;
+    bool sortRays = false;//波前模式下交点按材质排序、次级光线按方向卦限和起点网格排序
 
     Scene(int w, int h) : width(w), height(h)
     {}
+    ~Scene() { delete bvh; }
 
     void Add(Object *object) { objects.push_back(object); }
     void Add(std::unique_ptr<Light> light) { lights.push_back(std::move(light)); }
@@ -34,10 +53,34 @@ public:
     const std::vector<std::unique_ptr<Light> >&  get_lights() const { return lights; }
     // 该函数调用场景bvh类中的求交函数
     Intersection intersect(const Ray& ray) const;
+    // 批量求交，rays 与 hits 按下标一一对应
+    void intersect(const RayStream& rays, HitStream& hits) const;
+    // 光线包求交，适合同一 tile 的主光线和射向同一光源的阴影光线
+    void intersectPacket(const RayStream& rays, HitStream& hits) const;
+    // 遮挡查询：光线在 maxDistance 之内是否被任意物体挡住（阴影光线用）
+    bool intersectP(const Ray& ray, float maxDistance) const;
+    // 批量遮挡查询，每条光线的最大距离为 rays.tmax
+    void intersectP(const RayStream& rays, std::vector<uint8_t>& occluded) const;
     // 场景中的 bvh， 用来划分 obj
-    BVHAccel *bvh;
+    BVHAccel *bvh = nullptr;
     void buildBVH();
     Vector3f castRay(const Ray &ray, int depth) const;
+    // 按光线包做路径追踪：主光线整包求交，阴影光线按采样到的光源分组后整包求交，
+    // 之后的间接光照仍逐条递归 castRay；colors 与 rays 按下标一一对应
+    // streams 非空时为每条光线的采样流（与 rays 一一对应），处理第 i 条路径时绑定 streams[i]
+    void castRayPacket(const RayStream &rays, std::vector<Vector3f> &colors,
+                       std::vector<SampleStream> *streams = nullptr) const;
+    // 波前路径追踪：一大批路径按 生成 / 延伸 / 着色 / 阴影 分阶段推进，阶段之间通过 SoA 队列传递，
+    // 估计量与 castRay 相同；参数含义与 castRayPacket 相同
+    void castRayWavefront(const RayStream &rays, std::vector<Vector3f> &colors,
+                          std::vector<SampleStream> *streams = nullptr) const;
+    // 阴影光线的最大距离比到光源采样点的距离短一点，避免把光源本身当成遮挡物
+    static constexpr float kShadowEpsilon = 1e-2f;
+    // 直接光照：occluded 为着色点到 lightInter 之间是否被遮挡
+    Vector3f directLight(const Vector3f &wo, const Intersection &inter, const Intersection &lightInter,
+                         float pdf_light, bool occluded) const;
+    // 间接光照：俄罗斯轮盘赌决定是否继续弹射
+    Vector3f indirectLight(const Vector3f &wo, const Intersection &inter, int depth) const;
     void sampleLight(Intersection &pos, float &pdf) const;
 
     // creating the scene (adding objects and lights)
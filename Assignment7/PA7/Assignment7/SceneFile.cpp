@@ -0,0 +1,365 @@
+//
+// 场景文件解析与批量渲染的资源缓存
+//
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "SceneFile.hpp"
+#include "Triangle.hpp"
+#include "Sphere.hpp"
+
+namespace {
+
+std::string directoryOf(const std::string& path)
+{
+    auto pos = path.find_last_of('/');
+    return pos == std::string::npos ? std::string() : path.substr(0, pos + 1);
+}
+
+std::string resolvePath(const std::string& base, const std::string& path)
+{
+    if (path.empty() || path[0] == '/')
+        return path;
+    return directoryOf(base) + path;
+}
+
+std::string vectorKey(const Vector3f& v)
+{
+    std::ostringstream os;
+    os << v.x << ',' << v.y << ',' << v.z;
+    return os.str();
+}
+
+// 逐行读取场景文件，记录行号，出错时给出位置
+struct LineReader {
+    std::string filename;
+    int lineNumber = 0;
+
+    [[noreturn]] void fail(const std::string& message) const
+    {
+        throw std::runtime_error(filename + ":" + std::to_string(lineNumber) + ": " + message);
+    }
+
+    float toFloat(const std::string& s) const
+    {
+        try {
+            size_t used = 0;
+            float v = std::stof(s, &used);
+            if (used == s.size())
+                return v;
+        }
+        catch (const std::exception&) {}
+        fail("expected a number, got '" + s + "'");
+    }
+
+    int toInt(const std::string& s) const
+    {
+        float v = toFloat(s);
+        if (v != (int)v)
+            fail("expected an integer, got '" + s + "'");
+        return (int)v;
+    }
+
+    // "r,g,b" 或单个数字
+    Vector3f toVector(const std::string& s) const
+    {
+        std::vector<std::string> parts;
+        std::stringstream ss(s);
+        std::string part;
+        while (std::getline(ss, part, ','))
+            parts.push_back(part);
+        if (parts.size() == 1)
+            return Vector3f(toFloat(parts[0]));
+        if (parts.size() != 3)
+            fail("expected r,g,b, got '" + s + "'");
+        return Vector3f(toFloat(parts[0]), toFloat(parts[1]), toFloat(parts[2]));
+    }
+
+    void expectArgs(const std::vector<std::string>& tokens, size_t count) const
+    {
+        if (tokens.size() < count + 1)
+            fail("'" + tokens[0] + "' expects " + std::to_string(count) + " arguments");
+    }
+};
+
+} // namespace
+
+Material* AssetCache::material(const std::string& key, MaterialType type, const Vector3f& kd, const Vector3f& ks,
+                               const Vector3f& emission, float ior, float exponent)
+{
+    auto& slot = materials[key];
+    if (!slot) {
+        slot = std::make_unique<Material>(type, emission);
+        slot->Kd = kd;
+        slot->Ks = ks;
+        slot->ior = ior;
+        slot->specularExponent = exponent;
+    }
+    return slot.get();
+}
+
+Object* AssetCache::mesh(const std::string& path, Material* m)
+{
+    std::ostringstream key;
+    key << "mesh " << path << ' ' << m;
+    auto& slot = objects[key.str()];
+    if (slot) {
+        objectsReused++;
+        return slot.get();
+    }
+    std::ifstream probe(path);
+    if (!probe)
+        throw std::runtime_error("cannot open mesh " + path);
+    slot = std::make_unique<MeshTriangle>(path, m);
+    objectsCreated++;
+    return slot.get();
+}
+
+Object* AssetCache::sphere(const Vector3f& center, float radius, Material* m)
+{
+    std::ostringstream key;
+    key << "sphere " << vectorKey(center) << ' ' << radius << ' ' << m;
+    auto& slot = objects[key.str()];
+    if (slot) {
+        objectsReused++;
+        return slot.get();
+    }
+    slot = std::make_unique<Sphere>(center, radius, m);
+    objectsCreated++;
+    return slot.get();
+}
+
+std::unique_ptr<Scene> loadSceneFile(const std::string& filename, AssetCache& cache)
+{
+    std::ifstream in(filename);
+    if (!in)
+        throw std::runtime_error("cannot open scene file " + filename);
+
+    LineReader reader;
+    reader.filename = filename;
+
+    int width = 784, height = 784;
+    Scene defaults(width, height);
+    double fov = defaults.fov;
+    Vector3f eye = defaults.eye_pos;
+    int spp = defaults.spp;
+    int sppPerPass = defaults.sppPerPass;
+    double timeBudget = defaults.timeBudget;
+    float targetVariance = defaults.targetVariance;
+    std::string checkpoint = defaults.checkpoint;
+    float adaptiveThreshold = defaults.adaptiveThreshold;
+    int adaptiveMinSpp = defaults.adaptiveMinSpp;
+    std::string sampleMap = defaults.sampleMap;
+    SamplerType sampler = defaults.sampler;
+    IntegratorType integrator = defaults.integrator;
+    bool sortRays = defaults.sortRays;
+    float rr = defaults.RussianRoulette;
+    std::string output = defaults.output;
+    std::map<std::string, Material*> namedMaterials;
+    std::vector<Object*> objects;
+
+    auto findMaterial = [&](const std::string& name) {
+        auto it = namedMaterials.find(name);
+        if (it == namedMaterials.end())
+            reader.fail("unknown material '" + name + "'");
+        return it->second;
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        reader.lineNumber++;
+        auto comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream ls(line);
+        std::vector<std::string> tokens;
+        for (std::string t; ls >> t;)
+            tokens.push_back(t);
+        if (tokens.empty())
+            continue;
+
+        const std::string& cmd = tokens[0];
+        if (cmd == "resolution") {
+            reader.expectArgs(tokens, 2);
+            width = reader.toInt(tokens[1]);
+            height = reader.toInt(tokens[2]);
+            if (width <= 0 || height <= 0)
+                reader.fail("resolution must be positive");
+        }
+        else if (cmd == "fov") {
+            reader.expectArgs(tokens, 1);
+            fov = reader.toFloat(tokens[1]);
+        }
+        else if (cmd == "camera") {
+            reader.expectArgs(tokens, 3);
+            eye = Vector3f(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+        }
+        else if (cmd == "spp") {
+            reader.expectArgs(tokens, 1);
+            spp = reader.toInt(tokens[1]);
+            if (spp <= 0)
+                reader.fail("spp must be positive");
+        }
+        else if (cmd == "spp_per_pass") {
+            reader.expectArgs(tokens, 1);
+            sppPerPass = reader.toInt(tokens[1]);
+            if (sppPerPass <= 0)
+                reader.fail("spp_per_pass must be positive");
+        }
+        else if (cmd == "time_budget") {
+            reader.expectArgs(tokens, 1);
+            timeBudget = reader.toFloat(tokens[1]);
+        }
+        else if (cmd == "target_variance") {
+            reader.expectArgs(tokens, 1);
+            targetVariance = reader.toFloat(tokens[1]);
+        }
+        else if (cmd == "checkpoint") {
+            reader.expectArgs(tokens, 1);
+            checkpoint = resolvePath(filename, tokens[1]);
+        }
+        else if (cmd == "adaptive") {
+            reader.expectArgs(tokens, 1);
+            adaptiveThreshold = reader.toFloat(tokens[1]);
+            if (tokens.size() > 2)
+                adaptiveMinSpp = reader.toInt(tokens[2]);
+            if (adaptiveMinSpp < 2)
+                reader.fail("adaptive sampling needs at least 2 samples per pixel");
+        }
+        else if (cmd == "sample_map") {
+            reader.expectArgs(tokens, 1);
+            sampleMap = resolvePath(filename, tokens[1]);
+        }
+        else if (cmd == "sampler") {
+            reader.expectArgs(tokens, 1);
+            if (tokens[1] == "random")
+                sampler = SamplerType::Random;
+            else if (tokens[1] == "stratified")
+                sampler = SamplerType::Stratified;
+            else if (tokens[1] == "sobol")
+                sampler = SamplerType::Sobol;
+            else
+                reader.fail("unknown sampler '" + tokens[1] + "'");
+        }
+        else if (cmd == "integrator") {
+            reader.expectArgs(tokens, 1);
+            if (tokens[1] == "packet")
+                integrator = IntegratorType::Packet;
+            else if (tokens[1] == "wavefront")
+                integrator = IntegratorType::Wavefront;
+            else
+                reader.fail("unknown integrator '" + tokens[1] + "'");
+        }
+        else if (cmd == "sort_rays") {
+            reader.expectArgs(tokens, 1);
+            sortRays = reader.toInt(tokens[1]) != 0;
+        }
+        else if (cmd == "russian_roulette") {
+            reader.expectArgs(tokens, 1);
+            rr = reader.toFloat(tokens[1]);
+        }
+        else if (cmd == "output") {
+            reader.expectArgs(tokens, 1);
+            output = resolvePath(filename, tokens[1]);
+        }
+        else if (cmd == "material") {
+            reader.expectArgs(tokens, 2);
+            MaterialType type;
+            if (tokens[2] == "diffuse")
+                type = DIFFUSE;
+            else if (tokens[2] == "microfacet")
+                type = Microfacet;
+            else
+                reader.fail("unknown material type '" + tokens[2] + "'");
+
+            Vector3f kd(0.0f), ks(0.0f), emission(0.0f);
+            float ior = 1.0f, exponent = 0.0f;
+            for (size_t i = 3; i < tokens.size(); ++i) {
+                auto eq = tokens[i].find('=');
+                if (eq == std::string::npos)
+                    reader.fail("expected key=value, got '" + tokens[i] + "'");
+                std::string key = tokens[i].substr(0, eq), value = tokens[i].substr(eq + 1);
+                if (key == "kd") kd = reader.toVector(value);
+                else if (key == "ks") ks = reader.toVector(value);
+                else if (key == "emission") emission = reader.toVector(value);
+                else if (key == "ior") ior = reader.toFloat(value);
+                else if (key == "exponent") exponent = reader.toFloat(value);
+                else reader.fail("unknown material parameter '" + key + "'");
+            }
+            // 参数完全相同的材质共用一个对象，这样引用它的网格也能在任务之间复用
+            std::ostringstream key;
+            key << tokens[2] << ' ' << vectorKey(kd) << ' ' << vectorKey(ks) << ' ' << vectorKey(emission)
+                << ' ' << ior << ' ' << exponent;
+            namedMaterials[tokens[1]] = cache.material(key.str(), type, kd, ks, emission, ior, exponent);
+        }
+        else if (cmd == "mesh") {
+            reader.expectArgs(tokens, 2);
+            Material* m = findMaterial(tokens[2]);
+            try {
+                objects.push_back(cache.mesh(resolvePath(filename, tokens[1]), m));
+            }
+            catch (const std::runtime_error& e) {
+                reader.fail(e.what());
+            }
+        }
+        else if (cmd == "sphere") {
+            reader.expectArgs(tokens, 5);
+            Vector3f center(reader.toFloat(tokens[1]), reader.toFloat(tokens[2]), reader.toFloat(tokens[3]));
+            objects.push_back(cache.sphere(center, reader.toFloat(tokens[4]), findMaterial(tokens[5])));
+        }
+        else {
+            reader.fail("unknown directive '" + cmd + "'");
+        }
+    }
+
+    auto scene = std::make_unique<Scene>(width, height);
+    scene->fov = fov;
+    scene->eye_pos = eye;
+    scene->spp = spp;
+    scene->sppPerPass = sppPerPass;
+    scene->timeBudget = timeBudget;
+    scene->targetVariance = targetVariance;
+    scene->checkpoint = checkpoint;
+    scene->adaptiveThreshold = adaptiveThreshold;
+    scene->adaptiveMinSpp = adaptiveMinSpp;
+    scene->sampleMap = sampleMap;
+    scene->sampler = sampler;
+    scene->integrator = integrator;
+    scene->sortRays = sortRays;
+    scene->RussianRoulette = rr;
+    scene->output = output;
+    for (auto* object : objects)
+        scene->Add(object);
+    return scene;
+}
+
+std::vector<std::string> collectJobs(int argc, char** argv)
+{
+    std::vector<std::string> jobs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--jobs") {
+            if (i + 1 >= argc)
+                throw std::runtime_error("--jobs expects a list file");
+            std::string listFile = argv[++i];
+            std::ifstream list(listFile);
+            if (!list)
+                throw std::runtime_error("cannot open job list " + listFile);
+            std::string line;
+            while (std::getline(list, line)) {
+                auto comment = line.find('#');
+                if (comment != std::string::npos)
+                    line.erase(comment);
+                std::istringstream ls(line);
+                std::string path;
+                if (ls >> path)
+                    jobs.push_back(resolvePath(listFile, path));
+            }
+        }
+        else {
+            jobs.push_back(arg);
+        }
+    }
+    return jobs;
+}
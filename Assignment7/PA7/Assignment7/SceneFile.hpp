@@ -0,0 +1,58 @@
+//
+// 文本场景描述文件，以及批量渲染时在多个任务之间共享的资源缓存
+//
+// 每行一条指令，# 之后为注释，相对路径相对于场景文件所在目录：
+//   resolution <w> <h>
+//   fov <度数>
+//   camera <x> <y> <z>                  视点位置（看向 +z）
+//   spp <n>                             总采样数上限
+//   spp_per_pass <n>                    渐进式渲染每一遍的采样数（默认一遍采完 spp；开启 adaptive 时默认为最少 spp）
+//   time_budget <秒>
+//   target_variance <v>                 像素均值的平均方差（线性亮度）
+//   checkpoint <file>                   累积缓冲检查点，存在时从它继续
+//   adaptive <相对误差> [最少 spp]        自适应采样，每一遍之后才判断像素是否收敛，所以依赖 spp_per_pass
+//   sample_map <file.ppm>               采样数热力图
+//   sampler <random|stratified|sobol>
+//   integrator <packet|wavefront>
+//   sort_rays <0|1>                     波前模式下是否对交点和次级光线排序（默认 0）
+//   russian_roulette <p>
+//   output <file.ppm>
+//   material <name> <diffuse|microfacet> [kd=r,g,b] [ks=r,g,b] [emission=r,g,b] [ior=f] [exponent=f]
+//   mesh <file.obj> <material>
+//   sphere <x> <y> <z> <r> <material>
+// 颜色 / 向量可以写成 r,g,b，也可以只写一个数表示三个分量相同
+//
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Scene.hpp"
+#include "Material.hpp"
+
+// 多个渲染任务共享的资源：参数相同的材质、同一个文件 + 同一材质的网格（连同它内部的 BVH）、
+// 参数相同的球体都只创建一次，后面的任务直接复用
+class AssetCache
+{
+public:
+    Material* material(const std::string& key, MaterialType type, const Vector3f& kd, const Vector3f& ks,
+                       const Vector3f& emission, float ior, float exponent);
+    Object* mesh(const std::string& path, Material* m);
+    Object* sphere(const Vector3f& center, float radius, Material* m);
+
+    int objectsCreated = 0;//新创建的物体数
+    int objectsReused = 0;//直接复用缓存的物体数
+
+private:
+    std::map<std::string, std::unique_ptr<Material> > materials;
+    std::map<std::string, std::unique_ptr<Object> > objects;
+};
+
+// 读取一个场景文件，物体和材质从 cache 中获取；格式错误时抛出 std::runtime_error（带文件名和行号）
+// 返回的场景还没有构建 BVH
+std::unique_ptr<Scene> loadSceneFile(const std::string& filename, AssetCache& cache);
+
+// 解析命令行：参数为场景文件；--jobs <list> 从列表文件读取场景文件（每行一个，# 为注释）
+std::vector<std::string> collectJobs(int argc, char** argv);
@@ -9,7 +9,7 @@
 #include <cassert>
 #include <array>
 
-bool rayTriangleIntersect(const Vector3f& v0, const Vector3f& v1,
+inline bool rayTriangleIntersect(const Vector3f& v0, const Vector3f& v1,
                           const Vector3f& v2, const Vector3f& orig,
                           const Vector3f& dir, float& tnear, float& u, float& v)
 {
@@ -63,6 +63,12 @@ public:
     bool intersect(const Ray& ray, float& tnear,
                    uint32_t& index) const override;
     Intersection getIntersection(Ray ray) override;
+    bool intersectP(const Ray& ray, float tMax) override
+    {
+        float t;
+        uint32_t index;
+        return intersect(ray, t, index) && t < tMax;
+    }
     void getSurfaceProperties(const Vector3f& P, const Vector3f& I,
                               const uint32_t& index, const Vector2f& uv,
                               Vector3f& N, Vector2f& st) const override
@@ -205,6 +211,11 @@ public:
 
         return intersec;
     }
+
+    bool intersectP(const Ray& ray, float tMax)
+    {
+        return bvh && bvh->IntersectP(ray, tMax);
+    }
     
     void Sample(Intersection &pos, float &pdf){
         //首先通过bvh随机采样三角形，在通过这个三角形随机采样光源
@@ -233,10 +244,31 @@ public:
 };
 
 inline bool Triangle::intersect(const Ray& ray) { return true; }
+// 只求 t 的 Moller-Trumbore，与 getIntersection 一样剔除背面
 inline bool Triangle::intersect(const Ray& ray, float& tnear,
                                 uint32_t& index) const
 {
-    return false;
+    if (dotProduct(ray.direction, normal) > 0)
+        return false;
+    Vector3f pvec = crossProduct(ray.direction, e2);
+    double det = dotProduct(e1, pvec);
+    if (fabs(det) < EPSILON)
+        return false;
+    double det_inv = 1. / det;
+    Vector3f tvec = ray.origin - v0;
+    double u = dotProduct(tvec, pvec) * det_inv;
+    if (u < 0 || u > 1)
+        return false;
+    Vector3f qvec = crossProduct(tvec, e1);
+    double v = dotProduct(ray.direction, qvec) * det_inv;
+    if (v < 0 || u + v > 1)
+        return false;
+    double t = dotProduct(e2, qvec) * det_inv;
+    if (t < 0)
+        return false;
+    tnear = t;
+    index = 0;
+    return true;
 }
 
 inline Bounds3 Triangle::getBounds() { return Union(Bounds3(v0, v1), v2); }
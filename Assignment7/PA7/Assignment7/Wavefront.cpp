@@ -0,0 +1,123 @@
+//
+// 波前路径追踪：与 Scene::castRay 是同一个估计量（直接光照 + 俄罗斯轮盘赌的间接光照），
+// 只是按阶段整批处理路径，见 Wavefront.hpp
+//
+
+#include "Scene.hpp"
+#include "Wavefront.hpp"
+
+void Scene::castRayWavefront(const RayStream &rays, std::vector<Vector3f> &colors,
+                             std::vector<SampleStream> *streams) const
+{
+	size_t n = rays.size();
+	colors.assign(n, Vector3f(0, 0, 0));
+
+	// 1. 生成：主光线就是第 0 轮的队列，吞吐量为 1
+	PathQueue current, next;
+	current.rays = rays;
+	current.path.resize(n);
+	for (size_t i = 0; i < n; ++i)
+		current.path[i] = i;
+	current.betaR.assign(n, 1.0f);
+	current.betaG.assign(n, 1.0f);
+	current.betaB.assign(n, 1.0f);
+
+	HitStream hits;
+	ShadowQueue shadow;
+	std::vector<uint8_t> occluded;
+	std::vector<uint32_t> shading, keys, order, temp;
+	std::vector<Material*> materials;//本批遇到的材质，下标即材质编号
+	Bounds3 sceneBounds = bvh->WorldBound();
+	Vector3f extent = sceneBounds.Diagonal();
+	Vector3f invExtent(1.0f / std::max(extent.x, 1e-6f), 1.0f / std::max(extent.y, 1e-6f), 1.0f / std::max(extent.z, 1e-6f));
+
+	for (int depth = 0; !current.empty(); ++depth) {
+		// 2. 延伸：整批求交；主光线来自相邻的 tile，按光线包求交
+		if (depth == 0)
+			intersectPacket(current.rays, hits);
+		else
+			intersect(current.rays, hits);
+
+		// 没打中的路径结束；打中光源时只有主光线计入光源颜色（间接光照不重复计算直接光照）。
+		// 其余交点按材质排序，同一种材质的着色代码连续执行
+		shading.clear();
+		for (size_t i = 0; i < current.size(); ++i) {
+			if (!hits.happened[i])
+				continue;
+			Material *m = hits.m[i];
+			if (m->hasEmission()) {
+				if (depth == 0)
+					colors[current.path[i]] += m->getEmission();
+				continue;
+			}
+			shading.push_back(i);
+		}
+		// 按材质编号（sortRays 关闭时只按材质类型）对交点做基数排序
+		keys.resize(shading.size());
+		for (size_t k = 0; k < shading.size(); ++k) {
+			Material *m = hits.m[shading[k]];
+			if (!sortRays) {
+				keys[k] = m->m_type;
+				continue;
+			}
+			auto it = std::find(materials.begin(), materials.end(), m);
+			keys[k] = it - materials.begin();
+			if (it == materials.end())
+				materials.push_back(m);
+		}
+		sortByKey(keys, order, temp);
+		gather(shading, order);
+
+		// 3. 着色：每个交点采样一个光源点生成阴影光线，再用俄罗斯轮盘赌决定是否继续弹射；
+		//    随机数的使用顺序与 castRay 相同（光源、轮盘赌、材质采样）
+		next.clear();
+		shadow.clear();
+		for (uint32_t i : shading) {
+			uint32_t p = current.path[i];
+			SampleStreamScope bind(streams ? &(*streams)[p] : nullptr);
+			Intersection inter = hits.get(i);
+			Vector3f wo = current.rays.direction(i);
+			Vector3f beta = current.beta(i);
+			const Vector3f &N = inter.normal;
+
+			Intersection lightInter;
+			float pdf_light = 0.0f;
+			sampleLight(lightInter, pdf_light);
+			Vector3f L = directLight(wo, inter, lightInter, pdf_light, false);
+			if (L.x > 0 || L.y > 0 || L.z > 0) {
+				Vector3f diff = lightInter.coords - inter.coords;
+				shadow.push(inter.coords, diff.normalized(), diff.norm() - kShadowEpsilon, p, beta * L);
+			}
+
+			if (get_random_float() < RussianRoulette) {
+				Vector3f nextDir = inter.m->sample(wo, N).normalized();
+				float pdf = inter.m->pdf(wo, nextDir, N);
+				Vector3f f_r = inter.m->eval(wo, nextDir, N);
+				next.push(inter.coords, nextDir, p, beta * f_r * dotProduct(nextDir, N) / pdf / RussianRoulette);
+			}
+		}
+
+		// 次级光线和阴影光线按 方向卦限 + 起点网格 排序，延伸和遮挡查询时相邻光线走过的 BVH 节点大体相同
+		if (sortRays) {
+			keys.resize(next.size());
+			for (size_t k = 0; k < next.size(); ++k)
+				keys[k] = coherenceKey(next.rays, k, sceneBounds, invExtent);
+			sortByKey(keys, order, temp);
+			next.reorder(order);
+
+			keys.resize(shadow.size());
+			for (size_t k = 0; k < shadow.size(); ++k)
+				keys[k] = coherenceKey(shadow.rays, k, sceneBounds, invExtent);
+			sortByKey(keys, order, temp);
+			shadow.reorder(order);
+		}
+
+		// 4. 阴影：整批遮挡查询，没被挡住的直接光照加到路径颜色上
+		intersectP(shadow.rays, occluded);
+		for (size_t k = 0; k < shadow.size(); ++k)
+			if (!occluded[k])
+				colors[shadow.path[k]] += shadow.radiance(k);
+
+		std::swap(current, next);
+	}
+}
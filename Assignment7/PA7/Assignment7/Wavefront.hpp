@@ -0,0 +1,130 @@
+//
+// 波前（wavefront）路径追踪的队列：每一轮弹射的路径状态和阴影光线都按 SoA 存放
+//
+// 一批路径按阶段推进，而不是每条路径从头走到尾：
+//   生成主光线 -> 延伸（整批求交）-> 按材质类型着色（采样光源、俄罗斯轮盘赌、采样下一方向）-> 阴影（整批遮挡查询）
+// 着色阶段把还要继续的路径写进下一轮的 PathQueue，直到队列为空
+//
+
+#ifndef RAYTRACING_WAVEFRONT_H
+#define RAYTRACING_WAVEFRONT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Bounds3.hpp"
+#include "RayStream.hpp"
+
+// 一轮弹射中仍在继续的路径：要延伸的光线、所属路径、路径吞吐量
+struct PathQueue {
+    RayStream rays;
+    std::vector<uint32_t> path;//路径编号，即 castRayWavefront 中 rays / colors / streams 的下标
+    AlignedVector<float> betaR, betaG, betaB;//路径吞吐量：之前各次弹射的 brdf * cos / pdf / RR 之积
+
+    size_t size() const { return path.size(); }
+    bool empty() const { return path.empty(); }
+
+    void clear()
+    {
+        rays.clear();
+        path.clear();
+        betaR.clear(); betaG.clear(); betaB.clear();
+    }
+
+    void push(const Vector3f& origin, const Vector3f& dir, uint32_t p, const Vector3f& beta)
+    {
+        rays.push(origin, dir);
+        path.push_back(p);
+        betaR.push_back(beta.x); betaG.push_back(beta.y); betaB.push_back(beta.z);
+    }
+
+    Vector3f beta(size_t i) const { return Vector3f(betaR[i], betaG[i], betaB[i]); }
+
+    void reorder(const std::vector<uint32_t>& order)
+    {
+        rays.reorder(order);
+        gather(path, order);
+        gather(betaR, order); gather(betaG, order); gather(betaB, order);
+    }
+};
+
+// 阴影光线：没有被遮挡时把 L 加到对应路径的颜色上
+struct ShadowQueue {
+    RayStream rays;
+    std::vector<uint32_t> path;
+    AlignedVector<float> lr, lg, lb;
+
+    size_t size() const { return path.size(); }
+
+    void clear()
+    {
+        rays.clear();
+        path.clear();
+        lr.clear(); lg.clear(); lb.clear();
+    }
+
+    void push(const Vector3f& origin, const Vector3f& dir, float tMax, uint32_t p, const Vector3f& L)
+    {
+        rays.push(origin, dir, tMax);
+        path.push_back(p);
+        lr.push_back(L.x); lg.push_back(L.y); lb.push_back(L.z);
+    }
+
+    Vector3f radiance(size_t i) const { return Vector3f(lr[i], lg[i], lb[i]); }
+
+    void reorder(const std::vector<uint32_t>& order)
+    {
+        rays.reorder(order);
+        gather(path, order);
+        gather(lr, order); gather(lg, order); gather(lb, order);
+    }
+};
+
+// 光线的一致性排序键：高 3 位为方向所在卦限，低 12 位为起点所在网格单元（场景包围盒划分为 16^3，Morton 顺序）。
+// 按它排序后，相邻光线起点接近、方向符号相同，BVH 遍历访问的节点大体一致
+constexpr int kCoherenceKeyBits = 15;
+
+inline uint32_t coherenceKey(const RayStream& rays, size_t i, const Bounds3& bounds, const Vector3f& invExtent)
+{
+    uint32_t octant = (rays.dx[i] < 0) | ((rays.dy[i] < 0) << 1) | ((rays.dz[i] < 0) << 2);
+    float offset[3] = {(rays.ox[i] - bounds.pMin.x) * invExtent.x, (rays.oy[i] - bounds.pMin.y) * invExtent.y,
+                       (rays.oz[i] - bounds.pMin.z) * invExtent.z};
+    uint32_t cell = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        uint32_t c = std::min(15, std::max(0, int(offset[axis] * 16)));
+        for (int bit = 0; bit < 4; ++bit)
+            cell |= ((c >> bit) & 1) << (3 * bit + axis);
+    }
+    return (octant << 12) | cell;
+}
+
+// 按 kCoherenceKeyBits 位的键做两趟 LSD 基数排序，得到重排顺序（键相同时保持原来的相对顺序）
+inline void sortByKey(const std::vector<uint32_t>& keys, std::vector<uint32_t>& order, std::vector<uint32_t>& temp)
+{
+    constexpr int kRadixBits = (kCoherenceKeyBits + 1) / 2;
+    constexpr uint32_t kBuckets = 1u << kRadixBits;
+    size_t n = keys.size();
+    order.resize(n);
+    temp.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        temp[i] = i;
+    for (int shift = 0; shift < kCoherenceKeyBits; shift += kRadixBits) {
+        uint32_t offsets[kBuckets] = {0};
+        for (size_t i = 0; i < n; ++i)
+            offsets[(keys[i] >> shift) & (kBuckets - 1)]++;
+        uint32_t sum = 0;
+        for (uint32_t b = 0; b < kBuckets; ++b) {
+            uint32_t c = offsets[b];
+            offsets[b] = sum;
+            sum += c;
+        }
+        for (size_t k = 0; k < n; ++k) {
+            uint32_t i = temp[k];
+            order[offsets[(keys[i] >> shift) & (kBuckets - 1)]++] = i;
+        }
+        temp.swap(order);
+    }
+    order.swap(temp);
+}
+
+#endif //RAYTRACING_WAVEFRONT_H
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <cmath>
 #include <random>
+#include "Sampler.hpp"
 
 #undef M_PI
 #define M_PI 3.141592653589793f
@@ -28,11 +29,15 @@ inline  bool solveQuadratic(const float &a, const float &b, const float &c, floa
     return true;
 }
 
+// 当前线程绑定了采样流（见 Sampler.hpp）时取下一个维度，否则返回独立的均匀随机数
 inline float get_random_float()
 {
-    std::random_device dev;//
-    std::mt19937 rng(dev());
-    std::uniform_real_distribution<float> dist(0.f, 1.f); // distribution in range [1, 6]
+    if (SampleStream* stream = currentSampleStream())
+        return stream->next();
+
+    // 每个线程只用 random_device 播种一次，不再每次调用都重新构造生成器
+    static thread_local std::mt19937 rng(std::random_device{}());
+    std::uniform_real_distribution<float> dist(0.f, 1.f); // distribution in range [0, 1)
 
     return dist(rng);
 }
@@ -0,0 +1,93 @@
+#ifndef CGL_MATRIX4X4F_H
+#define CGL_MATRIX4X4F_H
+
+#include <cstddef>
+#include <iosfwd>
+
+#include "matrix4x4.h"
+#include "vector4f.h"
+
+namespace CGL {
+
+/**
+ * Single precision 4x4 matrix with 16-byte aligned columns.
+ * The float counterpart of Matrix4x4, using the same column major
+ * layout, so A(i,j) and A[j] mean the same thing in both classes.
+ * Products are computed as linear combinations of whole columns:
+ * A*x = x[0]*A[0] + x[1]*A[1] + x[2]*A[2] + x[3]*A[3],
+ * i.e. four broadcasts and four multiply-adds per vector.
+ */
+class Matrix4x4f {
+  public:
+
+  // The default constructor (all zeros).
+  Matrix4x4f( void ) { }
+
+  /**
+   * Converts a double precision matrix.
+   */
+  explicit Matrix4x4f( const Matrix4x4& A );
+
+  /**
+   * Returns a fresh 4x4 identity matrix.
+   */
+  static Matrix4x4f identity( void );
+
+  /**
+   * Returns the transpose of A.
+   */
+  Matrix4x4f T( void ) const;
+
+  /**
+   * Converts back to double precision.
+   */
+  Matrix4x4 toDouble( void ) const;
+
+  // accesses element (i,j) of A using 0-based indexing
+  // where (i, j) is (row, column).
+        float& operator()( int i, int j )       { return entries[j][i]; }
+  const float& operator()( int i, int j ) const { return entries[j][i]; }
+
+  // accesses the ith column of A
+        Vector4f& operator[]( int j )       { return entries[j]; }
+  const Vector4f& operator[]( int j ) const { return entries[j]; }
+
+  // returns A*x
+  inline Vector4f operator*( const Vector4f& x ) const {
+    simd::float4 r = simd::mul( entries[0].lanes(), simd::splat( x.x ) );
+    r = simd::madd( entries[1].lanes(), simd::splat( x.y ), r );
+    r = simd::madd( entries[2].lanes(), simd::splat( x.z ), r );
+    r = simd::madd( entries[3].lanes(), simd::splat( x.w ), r );
+    return Vector4f( r );
+  }
+
+  // returns A*B
+  Matrix4x4f operator*( const Matrix4x4f& B ) const;
+
+  /**
+   * Batch transform: out[i] = A * in[i] for i in [0, n).
+   * The four columns stay in registers for the whole batch.
+   * in and out may be the same array.
+   */
+  void transform( const Vector4f* in, Vector4f* out, size_t n ) const;
+
+  /**
+   * Batch transform of points with a homogeneous divide:
+   * out[i] = (A * in[i]) / w, with the resulting w kept in out[i].w
+   * so that callers can still reject points behind the camera.
+   */
+  void transformPoints( const Vector4f* in, Vector4f* out, size_t n ) const;
+
+  protected:
+
+  // 4 by 4 matrices are represented by an array of 4 column vectors.
+  Vector4f entries[4];
+
+}; // class Matrix4x4f
+
+// prints entries
+std::ostream& operator<<( std::ostream& os, const Matrix4x4f& A );
+
+} // namespace CGL
+
+#endif // CGL_MATRIX4X4F_H
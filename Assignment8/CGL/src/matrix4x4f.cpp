@@ -0,0 +1,102 @@
+#include "matrix4x4f.h"
+
+#include <iostream>
+
+using namespace std;
+
+namespace CGL {
+
+  Matrix4x4f::Matrix4x4f( const Matrix4x4& A ) {
+    for( int j = 0; j < 4; j++ )
+      entries[j] = Vector4f( A[j] );
+  }
+
+  Matrix4x4f Matrix4x4f::identity( void ) {
+    Matrix4x4f B;
+    for( int i = 0; i < 4; i++ )
+      B(i,i) = 1.f;
+    return B;
+  }
+
+  Matrix4x4f Matrix4x4f::T( void ) const {
+    const Matrix4x4f& A( *this );
+    Matrix4x4f B;
+
+    for( int i = 0; i < 4; i++ )
+    for( int j = 0; j < 4; j++ )
+    {
+       B(i,j) = A(j,i);
+    }
+
+    return B;
+  }
+
+  Matrix4x4 Matrix4x4f::toDouble( void ) const {
+    Matrix4x4 B;
+    for( int j = 0; j < 4; j++ )
+      B[j] = entries[j].to4D();
+    return B;
+  }
+
+  // Column j of A*B is A times column j of B.
+  Matrix4x4f Matrix4x4f::operator*( const Matrix4x4f& B ) const {
+    const Matrix4x4f& A( *this );
+    Matrix4x4f C;
+
+    for( int j = 0; j < 4; j++ )
+      C[j] = A * B[j];
+
+    return C;
+  }
+
+  void Matrix4x4f::transform( const Vector4f* in, Vector4f* out, size_t n ) const {
+    const simd::float4 c0 = entries[0].lanes(), c1 = entries[1].lanes(),
+                       c2 = entries[2].lanes(), c3 = entries[3].lanes();
+
+    for( size_t i = 0; i < n; i++ )
+    {
+       const Vector4f& x = in[i];
+       simd::float4 r = simd::mul( c0, simd::splat( x.x ) );
+       r = simd::madd( c1, simd::splat( x.y ), r );
+       r = simd::madd( c2, simd::splat( x.z ), r );
+       r = simd::madd( c3, simd::splat( x.w ), r );
+       simd::store( &out[i].x, r );
+    }
+  }
+
+  void Matrix4x4f::transformPoints( const Vector4f* in, Vector4f* out, size_t n ) const {
+    const simd::float4 c0 = entries[0].lanes(), c1 = entries[1].lanes(),
+                       c2 = entries[2].lanes(), c3 = entries[3].lanes();
+
+    for( size_t i = 0; i < n; i++ )
+    {
+       const Vector4f& x = in[i];
+       simd::float4 r = simd::mul( c0, simd::splat( x.x ) );
+       r = simd::madd( c1, simd::splat( x.y ), r );
+       r = simd::madd( c2, simd::splat( x.z ), r );
+       r = simd::madd( c3, simd::splat( x.w ), r );
+       Vector4f p( r );
+       float w = p.w;
+       p *= 1.f / w;
+       p.w = w;
+       out[i] = p;
+    }
+  }
+
+  std::ostream& operator<<( std::ostream& os, const Matrix4x4f& A ) {
+    for( int i = 0; i < 4; i++ )
+    {
+       os << "[ ";
+
+       for( int j = 0; j < 4; j++ )
+       {
+          os << A(i,j) << " ";
+       }
+
+       os << "]" << std::endl;
+    }
+
+    return os;
+  }
+
+} // namespace CGL
@@ -0,0 +1,10 @@
+#include "vector4f.h"
+
+namespace CGL {
+
+  std::ostream& operator<<( std::ostream& os, const Vector4f& v ) {
+    os << "{ " << v.x << ", " << v.y << ", " << v.z << ", " << v.w << " }";
+    return os;
+  }
+
+} // namespace CGL
@@ -0,0 +1,137 @@
+// Micro-benchmark: double precision CGL math (Vector3D, Vector4D, Matrix4x4)
+// against the single precision SIMD family (Vector4f, Matrix4x4f).
+// Usage: simd_bench [number of vectors]
+#include "matrix4x4.h"
+#include "matrix4x4f.h"
+#include "vector3D.h"
+#include "vector4D.h"
+#include "vector4f.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace CGL;
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// best of a few runs, in milliseconds
+template <typename F> double time_ms( F f ) {
+  double best = 1e30;
+  for( int run = 0; run < 5; run++ ) {
+    Clock::time_point start = Clock::now();
+    f();
+    best = min( best, chrono::duration<double, milli>( Clock::now() - start ).count() );
+  }
+  return best;
+}
+
+void report( const char* name, double ms_double, double ms_float, double error ) {
+  printf( "%-28s double %8.3f ms   float %8.3f ms   speedup %5.2fx   max error %.2g\n",
+          name, ms_double, ms_float, ms_double / ms_float, error );
+}
+
+int main( int argc, char* argv[] ) {
+  size_t n = argc > 1 ? (size_t) atol( argv[1] ) : ( 1 << 20 );
+
+  // the same random data in both precisions
+  srand( 1 );
+  vector<Vector4D> points_d( n ), normals_d( n ), out_d( n );
+  vector<Vector3D> a3( n ), b3( n ), out3( n );
+  vector<Vector4f> points_f( n ), normals_f( n ), out_f( n );
+  for( size_t i = 0; i < n; i++ ) {
+    double v[6];
+    for( int k = 0; k < 6; k++ ) v[k] = rand() / (double) RAND_MAX * 2 - 1;
+    points_d[i] = Vector4D( v[0], v[1], v[2], 1 );
+    normals_d[i] = Vector4D( v[3], v[4], v[5], 0 );
+    a3[i] = Vector3D( v[0], v[1], v[2] );
+    b3[i] = Vector3D( v[3], v[4], v[5] );
+    points_f[i] = Vector4f( points_d[i] );
+    normals_f[i] = Vector4f( normals_d[i] );
+  }
+
+  // a perspective * view matrix
+  double data[16] = { 1.2, 0.1, 0.0,  0.3,
+                      0.0, 1.5, 0.2, -0.4,
+                      0.1, 0.0, -1.1, -2.0,
+                      0.0, 0.0, -1.0,  0.0 };
+  Matrix4x4 M( data );
+  Matrix4x4f Mf( M );
+
+  printf( "%zu vectors\n", n );
+
+  // A * x
+  double td = time_ms( [&]() {
+    for( size_t i = 0; i < n; i++ ) out_d[i] = M * points_d[i];
+  } );
+  double tf = time_ms( [&]() { Mf.transform( &points_f[0], &out_f[0], n ); } );
+  double error = 0;
+  for( size_t i = 0; i < n; i++ )
+    error = max( error, ( out_f[i].to4D() - out_d[i] ).norm() );
+  report( "transform", td, tf, error );
+
+  // A * x with the homogeneous divide
+  td = time_ms( [&]() {
+    for( size_t i = 0; i < n; i++ ) {
+      Vector4D p = M * points_d[i];
+      double w = p.w;
+      p = p / w;
+      p.w = w;
+      out_d[i] = p;
+    }
+  } );
+  tf = time_ms( [&]() { Mf.transformPoints( &points_f[0], &out_f[0], n ); } );
+  // points that land (almost) on the camera plane are ill-conditioned in any precision
+  error = 0;
+  for( size_t i = 0; i < n; i++ )
+    if( fabs( out_d[i].w ) > 0.1 )
+      error = max( error, ( out_f[i].to4D() - out_d[i] ).norm() / max( 1.0, out_d[i].norm() ) );
+  report( "transformPoints (relative)", td, tf, error );
+
+  // A * B, chained
+  size_t m = max( n / 16, (size_t) 1 );
+  Matrix4x4 Pd = Matrix4x4::identity();
+  Matrix4x4f Pf = Matrix4x4f::identity();
+  // a rotation, so that the chained product stays bounded
+  double c = cos( 1e-3 ), s = sin( 1e-3 );
+  double rotation[16] = { c, -s, 0, 0,
+                          s,  c, 0, 0,
+                          0,  0, 1, 0,
+                          0,  0, 0, 1 };
+  Matrix4x4 Rd( rotation );
+  Matrix4x4f Rf( Rd );
+  td = time_ms( [&]() { for( size_t i = 0; i < m; i++ ) Pd = Rd * Pd; } );
+  tf = time_ms( [&]() { for( size_t i = 0; i < m; i++ ) Pf = Rf * Pf; } );
+  report( "matrix * matrix", td, tf, ( Pf.toDouble() - Pd ).norm() );
+
+  // cross + normalize
+  td = time_ms( [&]() {
+    for( size_t i = 0; i < n; i++ ) out3[i] = cross( a3[i], b3[i] ).unit();
+  } );
+  tf = time_ms( [&]() {
+    for( size_t i = 0; i < n; i++ ) out_f[i] = cross( points_f[i], normals_f[i] ).unit();
+  } );
+  error = 0;
+  for( size_t i = 0; i < n; i++ )
+    error = max( error, ( out_f[i].to3D() - out3[i] ).norm() );
+  report( "cross + normalize", td, tf, error );
+
+  // dot
+  double sum_d = 0;
+  float sum_f = 0;
+  td = time_ms( [&]() {
+    sum_d = 0;
+    for( size_t i = 0; i < n; i++ ) sum_d += dot( points_d[i], normals_d[i] );
+  } );
+  tf = time_ms( [&]() {
+    sum_f = 0;
+    for( size_t i = 0; i < n; i++ ) sum_f += dot( points_f[i], normals_f[i] );
+  } );
+  report( "dot (sum)", td, tf, fabs( sum_f - sum_d ) / n );
+
+  return 0;
+}
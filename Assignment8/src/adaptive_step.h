@@ -0,0 +1,134 @@
+#ifndef ADAPTIVE_STEP_H
+#define ADAPTIVE_STEP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "mass_spring.h"
+#include "particle_system.h"
+
+using namespace std;
+
+namespace CGL {
+
+// 自适应子步：把一帧的时间切成若干个不等长的子步，每个子步之前按当前状态估计允许的步长。
+//   稳定性：显式积分（Euler / Verlet）要求 dt < 2 / omega_max。omega_max^2 用 Gershgorin 圆盘估计，
+//           不超过 max_i 2 w_i sum_{弹簧 s 连着 i} k_s，只与弹簧和质量有关，拓扑不变时缓存；
+//           隐式欧拉和 XPBD 无条件稳定，不受这一项限制。
+//   精度（CFL）：每根弹簧两端的相对位移一步内不超过静止长度的 courant 倍，即 |v_a - v_b| dt <= courant L。
+// 步长还限制在 [帧长 / max_substeps, 帧长 / min_substeps] 之内，一步最多增大到上一步的 max_growth 倍。
+// 系统又硬又快的时候多分几步，静止下来以后一帧只走一两步
+template <typename Vec> class AdaptiveTimestep {
+public:
+  double courant = 0.5;         // 一步内弹簧两端相对位移与静止长度之比的上限
+  double stability_safety = 0.5; // 实际步长取稳定极限的多少倍
+  double max_growth = 2;
+  int min_substeps = 1;
+  int max_substeps = 1000;
+
+  int last_substeps = 0; // 上一帧实际走的子步数
+  double last_min_dt = 0, last_max_dt = 0;
+
+  // 用若干个子步把 system 推进 frame_time，返回子步数。System 需要提供 simulate(integrator, dt, gravity)
+  template <typename System>
+  int advance(System &system, Integrator integrator, double frame_time, const Vec &gravity) {
+    const double dt_min = frame_time / max_substeps;
+    const double dt_max = frame_time / max(min_substeps, 1);
+    double remaining = frame_time;
+    int substeps = 0;
+    last_min_dt = frame_time;
+    last_max_dt = 0;
+    while (remaining > 1e-12 * frame_time) {
+      system.prepare();
+      double dt = estimate(system, integrator);
+      if (last_dt > 0)
+        dt = min(dt, last_dt * max_growth);
+      dt = max(dt_min, min(dt, dt_max));
+      // 剩下的时间不到两步时平分，避免最后留下一个很短的子步
+      if (dt >= remaining)
+        dt = remaining;
+      else if (dt > remaining / 2)
+        dt = remaining / 2;
+      if (integrator == Integrator::Verlet)
+        rescaleVerlet(system, dt);
+      system.simulate(integrator, dt, gravity);
+      last_dt = dt;
+      remaining -= dt;
+      substeps++;
+      last_min_dt = min(last_min_dt, dt);
+      last_max_dt = max(last_max_dt, dt);
+    }
+    last_substeps = substeps;
+    return substeps;
+  }
+
+  // 当前状态下允许的最大步长（未做上下限和增长限制）
+  double estimate(const ParticleSystem<Vec> &system, Integrator integrator) {
+    double dt = HUGE_VAL;
+    if (integrator == Integrator::Euler || integrator == Integrator::Verlet)
+      dt = stabilityLimit(system) * stability_safety;
+
+    // Verlet 的速度隐含在 x - x_last 里，velocities 只是辅助量
+    const SpringArrays &s = system.springs;
+    const Vec *x = system.positions.data(), *x_last = system.last_positions.data();
+    const Vec *v = system.velocities.data();
+    const bool verlet = integrator == Integrator::Verlet && last_dt > 0;
+    const double inv_last_dt = verlet ? 1.0 / last_dt : 0;
+    const int m = (int)s.size();
+    double max_rate = 0; // max |v_a - v_b| / L
+#pragma omp parallel for schedule(static) reduction(max : max_rate) if (m >= kParallelGrain)
+    for (int j = 0; j < m; j++) {
+      uint32_t a = s.m1[j], b = s.m2[j];
+      Vec relative = verlet ? ((x[a] - x_last[a]) - (x[b] - x_last[b])) * inv_last_dt
+                            : v[a] - v[b];
+      max_rate = max(max_rate, relative.norm() / s.rest_length[j]);
+    }
+    if (max_rate > 0)
+      dt = min(dt, courant / max_rate);
+    return dt;
+  }
+
+  // 显式积分的稳定步长 2 / omega_max
+  double stabilityLimit(const ParticleSystem<Vec> &system) {
+    const SpringArrays &s = system.springs;
+    if (topology != s.topology || stiffness_n != system.numMasses()) {
+      const size_t n = system.numMasses();
+      vector<double> stiffness(n, 0);
+      for (size_t j = 0; j < s.size(); j++) {
+        stiffness[s.m1[j]] += s.k[j];
+        stiffness[s.m2[j]] += s.k[j];
+      }
+      double omega2 = 0;
+      for (size_t i = 0; i < n; i++)
+        omega2 = max(omega2, 2 * system.inv_masses[i] * stiffness[i]);
+      stable_dt = omega2 > 0 ? 2 / sqrt(omega2) : HUGE_VAL;
+      topology = s.topology;
+      stiffness_n = n;
+    }
+    return stable_dt;
+  }
+
+private:
+  // Verlet 默认前后两步等长；步长由 last_dt 变为 dt 时按比例缩放 x - x_last，隐含的速度保持不变
+  void rescaleVerlet(ParticleSystem<Vec> &system, double dt) {
+    if (last_dt <= 0 || dt == last_dt)
+      return;
+    Vec *x = system.positions.data(), *x_last = system.last_positions.data();
+    const double ratio = dt / last_dt;
+    const int n = (int)system.numMasses();
+#pragma omp parallel for simd schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++)
+      x_last[i] = x[i] - (x[i] - x_last[i]) * ratio;
+  }
+
+  double last_dt = 0;
+  uint32_t topology = 0;
+  size_t stiffness_n = 0;
+  double stable_dt = HUGE_VAL;
+};
+
+} // namespace CGL
+
+#endif /* ADAPTIVE_STEP_H */
@@ -5,9 +5,17 @@
 
 namespace CGL {
 
-Application::Application(AppConfig config) { this->config = config; }
+Application::Application(AppConfig config)
+    : ropeEuler(NULL), ropeVerlet(NULL), ropeImplicit(NULL) {
+  this->config = config;
+}
 
-Application::~Application() {}
+Application::~Application() {
+  //绳子的质点和弹簧都在各自的连续数组里，delete 一次就全部释放
+  delete ropeEuler;
+  delete ropeVerlet;
+  delete ropeImplicit;
+}
 
 void Application::init() {
   // Enable anti-aliasing and circular points.
@@ -24,43 +32,61 @@ void Application::init() {
   glColor3f(1.0, 1.0, 1.0);
   
   // Create two ropes 
-  ropeEuler = new Rope(Vector2D(-100, 500), Vector2D(200, 500), 9, config.mass,
-                       config.ks, {0});
-  ropeVerlet = new Rope(Vector2D(0, 500), Vector2D(300, 500), 9, config.mass,
-                        config.ks, {0});
+  ropeEuler = new Rope(Vector2D(-100, 500), Vector2D(200, 500),
+                       config.num_nodes, config.mass, config.ks, {0});
+  ropeVerlet = new Rope(Vector2D(0, 500), Vector2D(300, 500),
+                        config.num_nodes, config.mass, config.ks, {0});
+  ropeImplicit = new Rope(Vector2D(100, 500), Vector2D(400, 500),
+                          config.num_nodes, config.mass, config.ks, {0});
+  ropeVerlet->xpbd.iterations = config.xpbd_iterations;
 }
 
 void Application::render() {
   //Simulation loops
-  for (int i = 0; i < config.steps_per_frame; i++) {
+  if (config.adaptive_steps) {
+    //每帧 1 个时间单位
+    eulerSteps.advance(*ropeEuler, Integrator::Euler, 1.0, config.gravity);
+    verletSteps.advance(*ropeVerlet,
+                        config.use_xpbd ? Integrator::XPBD : Integrator::Verlet,
+                        1.0, config.gravity);
+  } else for (int i = 0; i < config.steps_per_frame; i++) {
     ropeEuler->simulateEuler(1.0 / config.steps_per_frame, config.gravity);
-    ropeVerlet->simulateVerlet(1.0 / config.steps_per_frame, config.gravity);
+    if (config.use_xpbd)
+      ropeVerlet->simulateXPBD(1.0 / config.steps_per_frame, config.gravity);
+    else
+      ropeVerlet->simulateVerlet(1.0 / config.steps_per_frame, config.gravity);
+  }
+  for (int i = 0; i < config.implicit_steps_per_frame; i++) {
+    ropeImplicit->simulateImplicit(1.0 / config.implicit_steps_per_frame,
+                                   config.gravity);
   }
   // Rendering ropes
   Rope *rope;
 
-  for (int i = 0; i < 2; i++) {
+  for (int i = 0; i < 3; i++) {
     if (i == 0) {
       glColor3f(0.0, 0.0, 1.0);
       rope = ropeEuler;
-    } else {
+    } else if (i == 1) {
       glColor3f(0.0, 1.0, 0.0);
       rope = ropeVerlet;
+    } else {
+      glColor3f(1.0, 0.0, 0.0);
+      rope = ropeImplicit;
     }
 
     //渲染 点
     glBegin(GL_POINTS);
-    for (auto &m : rope->masses) {
-      Vector2D p = m->position;
+    for (auto &p : rope->positions) {
       glVertex2d(p.x, p.y);
     }
     glEnd();
 
     //渲染 线
     glBegin(GL_LINES);
-    for (auto &s : rope->springs) {
-      Vector2D p1 = s->m1->position;
-      Vector2D p2 = s->m2->position;
+    for (size_t s = 0; s < rope->springs.size(); s++) {
+      Vector2D p1 = rope->positions[rope->springs.m1[s]];
+      Vector2D p2 = rope->positions[rope->springs.m2[s]];
       glVertex2d(p1.x, p1.y);
       glVertex2d(p2.x, p2.y);
     }
@@ -92,6 +118,14 @@ void Application::keyboard_event(int key, int event, unsigned char mods) {
   case '=':
     config.steps_per_frame *= 2;
     break;
+  case 'X':
+    if (event == EVENT_PRESS)
+      config.use_xpbd = !config.use_xpbd;
+    break;
+  case 'A':
+    if (event == EVENT_PRESS)
+      config.adaptive_steps = !config.adaptive_steps;
+    break;
   }
 }
 
@@ -100,6 +134,17 @@ string Application::name() { return "Rope Simulator"; }
 string Application::info() {
   ostringstream steps;
   steps << "Steps per frame: " << config.steps_per_frame;
+  if (config.adaptive_steps)
+    steps << " (adaptive: blue " << eulerSteps.last_substeps << ", green "
+          << verletSteps.last_substeps << ")";
+  steps << ", implicit: " << config.implicit_steps_per_frame;
+  // 链状的红色绳子走块追赶法，没有 CG 迭代
+  if (ropeImplicit->implicit.last_direct)
+    steps << " (direct)";
+  else
+    steps << " (CG iterations " << ropeImplicit->implicit.last_iterations
+          << ")";
+  steps << ", green: " << (config.use_xpbd ? "XPBD" : "Verlet");
 
   return steps.str();
 }
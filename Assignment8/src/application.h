@@ -10,9 +10,11 @@
 
 // libCGL
 #include "CGL/CGL.h"
+#include "CGL/misc.h"
 #include "CGL/osdtext.h"
 #include "CGL/renderer.h"
 
+#include "adaptive_step.h"
 #include "rope.h"
 
 using namespace std;
@@ -24,17 +26,34 @@ struct AppConfig {
     // Rope config variables 绳子 配置 变量
     mass = 1;
     ks = 0.1;
+    num_nodes = 9;
 
     // Environment variables
     gravity = Vector2D(0, -1);//重力
 
     steps_per_frame = 30;//????为什么小于10就完全变了
+    //显式积分（Euler / Verlet）的步长受弹簧刚度限制，步长太大就发散；
+    //隐式欧拉无条件稳定，每帧一大步即可
+    implicit_steps_per_frame = 1;
+
+    //自适应子步（A 键切换）：蓝色、绿色绳子每帧的子步数按稳定性和 CFL 估计自动选取，
+    //此时不使用 steps_per_frame
+    adaptive_steps = false;
+
+    //绿色绳子用 XPBD 约束求解代替 Verlet 的弹簧力（X 键切换）
+    use_xpbd = false;
+    xpbd_iterations = 10;
   }
 
   float mass;//质量
   float ks;//系数(hook系数,弹簧力系数)
+  int num_nodes;//每根绳子的节点数
 
   float steps_per_frame;
+  int implicit_steps_per_frame;
+  bool adaptive_steps;
+  bool use_xpbd;
+  int xpbd_iterations;
   Vector2D gravity;//重力
 };
 
@@ -51,6 +70,8 @@ public:
   std::string info();
 
   void keyboard_event(int key, int event, unsigned char mods);
+  // Viewer 只在按下时调用 key_event，转给 keyboard_event
+  void key_event(char key) { keyboard_event(key, EVENT_PRESS, 0); }
   // void cursor_event(float x, float y);
   // void scroll_event(float offset_x, float offset_y);
   // void mouse_event(int key, int event, unsigned char mods);
@@ -60,6 +81,10 @@ private:
 
   Rope *ropeEuler;//欧拉 rope
   Rope *ropeVerlet;//verlet rope
+  Rope *ropeImplicit;//隐式欧拉 rope
+
+  AdaptiveTimestep<Vector2D> eulerSteps;
+  AdaptiveTimestep<Vector2D> verletSteps;
 
   size_t screen_width;
   size_t screen_height;
@@ -0,0 +1,84 @@
+#include <algorithm>
+
+#include "cloth.h"
+
+namespace CGL {
+
+Cloth::Cloth(const Vector3D &origin, const Vector3D &du, const Vector3D &dv,
+             int nu, int nv, float node_mass, float k_structural,
+             float k_shear, float k_bend)
+    : nu(nu), nv(nv), thickness(1e-3) {
+  addGrid(origin, du, dv, nu, nv, node_mass, k_structural, k_shear, k_bend);
+}
+
+void Cloth::simulate(Integrator integrator, float delta_t, Vector3D gravity) {
+  prepare();
+  switch (integrator) {
+  case Integrator::Euler:
+    stepEuler(delta_t, gravity, 0.01);
+    break;
+  case Integrator::Verlet:
+    stepVerlet(delta_t, gravity, 0.05);
+    break;
+  case Integrator::Implicit:
+    implicit.step(springs, positions.data(), velocities.data(),
+                  inv_masses.data(), numMasses(), gravity, delta_t, 0.01);
+    break;
+  case Integrator::XPBD:
+    xpbd.step(springs, positions.data(), last_positions.data(),
+              velocities.data(), inv_masses.data(), numMasses(), gravity,
+              delta_t);
+    break;
+  }
+  self_collision.apply(*this, delta_t);
+  collide(delta_t);
+}
+
+// 把速度 v 在法向 n 上分解：去掉指向内部的法向分量，切向分量乘以 (1 - friction)
+static inline Vector3D collisionVelocity(const Vector3D &v, const Vector3D &n,
+                                         double friction) {
+  double vn = dot(v, n);
+  Vector3D tangent = v - n * vn;
+  return tangent * (1 - friction) + n * max(vn, 0.0);
+}
+
+void Cloth::collide(float delta_t) {
+  if (planes.empty() && spheres.empty())
+    return;
+  Vector3D *x = positions.data(), *x_last = last_positions.data();
+  Vector3D *v = velocities.data();
+  const double *w = inv_masses.data();
+  const int n = (int)numMasses();
+#pragma omp parallel for schedule(static) if (n >= kParallelGrain)
+  for (int i = 0; i < n; i++) {
+    if (w[i] == 0)
+      continue;
+    bool hit = false;
+    for (size_t p = 0; p < planes.size(); p++) {
+      const CollisionPlane &plane = planes[p];
+      double d = dot(x[i] - plane.point, plane.normal);
+      if (d < thickness) {
+        x[i] += plane.normal * (thickness - d);
+        v[i] = collisionVelocity(v[i], plane.normal, plane.friction);
+        hit = true;
+      }
+    }
+    for (size_t s = 0; s < spheres.size(); s++) {
+      const CollisionSphere &sphere = spheres[s];
+      Vector3D offset = x[i] - sphere.center;
+      double d = offset.norm();
+      double r = sphere.radius + thickness;
+      if (d < r && d > 0) {
+        Vector3D normal = offset / d;
+        x[i] = sphere.center + normal * r;
+        v[i] = collisionVelocity(v[i], normal, sphere.friction);
+        hit = true;
+      }
+    }
+    // Verlet 由 x - x_last 隐含速度，改成与修正后的速度一致
+    if (hit)
+      x_last[i] = x[i] - v[i] * delta_t;
+  }
+}
+
+} // namespace CGL
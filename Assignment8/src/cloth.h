@@ -0,0 +1,61 @@
+#ifndef CLOTH_H
+#define CLOTH_H
+
+#include <vector>
+
+#include "CGL/vector3D.h"
+#include "implicit.h"
+#include "mass_spring.h"
+#include "particle_system.h"
+#include "spatial_hash.h"
+#include "xpbd.h"
+
+using namespace std;
+
+namespace CGL {
+
+// 碰撞平面：点 point、单位法向 normal 的一侧为外部
+struct CollisionPlane {
+  Vector3D point;
+  Vector3D normal;
+  double friction; // 碰撞时切向速度损失的比例，0 ~ 1
+};
+
+struct CollisionSphere {
+  Vector3D center;
+  double radius;
+  double friction;
+};
+
+// 三维质点弹簧布料：nu x nv 的网格，结构、剪切、弯曲三类弹簧（见 ParticleSystem::addGrid），
+// 每一步积分后与平面、球做碰撞处理。弹簧力、隐式欧拉、XPBD 用的是和 Rope 相同的模板
+class Cloth : public ParticleSystem<Vector3D> {
+public:
+  // 质点 (i, j) 位于 origin + i * du + j * dv，下标为 j * nu + i
+  Cloth(const Vector3D &origin, const Vector3D &du, const Vector3D &dv, int nu,
+        int nv, float node_mass, float k_structural, float k_shear, float k_bend);
+
+  uint32_t index(int i, int j) const { return j * nu + i; }
+
+  // 积分一步，再处理自碰撞和与碰撞体的碰撞；阻尼系数与 Rope 的各个积分方式相同
+  void simulate(Integrator integrator, float delta_t, Vector3D gravity);
+
+  int nu, nv;
+
+  vector<CollisionPlane> planes;
+  vector<CollisionSphere> spheres;
+  double thickness; // 质点与碰撞体之间保持的最小距离
+
+  ImplicitSolver<3> implicit;
+  XPBDSolver<Vector3D> xpbd;
+  // 质点之间的自碰撞，radius 为 0（默认）时关闭
+  SelfCollision<Vector3D> self_collision;
+
+private:
+  // 把穿进碰撞体的质点推回表面，去掉指向碰撞体内部的法向速度并按摩擦衰减切向速度
+  void collide(float delta_t);
+};
+
+} // namespace CGL
+
+#endif /* CLOTH_H */
@@ -0,0 +1,213 @@
+// 无窗口的模拟驱动：固定步长推进若干根绳子（或一块三维布料）N 步，尽可能快地跑，
+// 可选地把每一步的统计量和质点位置写入二进制轨迹文件（格式见 trace.h），最后报告每秒模拟的步数。
+// 不依赖 GLFW / OpenGL，可以在没有显示器的服务器上做参数扫描
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include "adaptive_step.h"
+#include "cloth.h"
+#include "rope.h"
+#include "trace.h"
+
+using namespace std;
+using namespace CGL;
+
+void usage(const char *binaryName) {
+  printf("Usage: %s [options]\n", binaryName);
+  printf("Program Options:\n");
+  printf("  -i  <NAME>             Integrator: euler, verlet, implicit, xpbd (default verlet)\n");
+  printf("  -n  <INT>              Number of nodes per rope\n");
+  printf("  -c  <INT>              Number of ropes, side by side in one particle system\n");
+  printf("  -w  <INT>              Simulate a 3D INT x INT cloth over a sphere instead of ropes\n");
+  printf("  -m  <FLOAT>            Mass per node\n");
+  printf("  -k  <FLOAT>            Spring constant\n");
+  printf("  -g  <FLOAT> <FLOAT>    Gravity vector (x, y)\n");
+  printf("  -t  <FLOAT>            Timestep (frame length with -a)\n");
+  printf("  -N  <INT>              Number of steps\n");
+  printf("  -x  <INT>              XPBD iterations per step\n");
+  printf("  -r  <FLOAT>            Particle self-collision radius (0 = off)\n");
+  printf("  -a                     Adaptive substeps: split each timestep by a CFL / stability estimate\n");
+  printf("  -o  <FILE>             Write a binary trace to FILE\n");
+  printf("  -d  <INT>              Also dump node positions every INT steps (0 = metrics only)\n");
+  printf("\n");
+}
+
+// 固定步长推进 system，计时并可选地写轨迹文件。adaptive 不为空时每一步再由它切成若干个子步
+template <typename System, typename Vec>
+int run(System &system, const string &label, Integrator integrator,
+        const Vec &gravity, double delta_t, long steps,
+        const string &trace_path, int state_interval,
+        AdaptiveTimestep<Vec> *adaptive) {
+  TraceWriter trace;
+  bool tracing = !trace_path.empty();
+  if (tracing && !trace.open(trace_path, system, integrator, delta_t, state_interval)) {
+    fprintf(stderr, "cannot open trace file %s\n", trace_path.c_str());
+    return 1;
+  }
+
+  // 计时只包括模拟本身，统计量和写文件单独计时
+  double simulate_seconds = 0, trace_seconds = 0;
+  long substeps = 0;
+  double min_dt = delta_t, max_dt = 0;
+  typedef chrono::steady_clock Clock;
+  for (long step = 0; step < steps; step++) {
+    Clock::time_point start = Clock::now();
+    if (adaptive) {
+      substeps += adaptive->advance(system, integrator, delta_t, gravity);
+      min_dt = min(min_dt, adaptive->last_min_dt);
+      max_dt = max(max_dt, adaptive->last_max_dt);
+    } else {
+      system.simulate(integrator, delta_t, gravity);
+    }
+    Clock::time_point end = Clock::now();
+    simulate_seconds += chrono::duration<double>(end - start).count();
+
+    if (tracing) {
+      if (!trace.write(step + 1, (step + 1) * delta_t, measure(system, gravity), system)) {
+        fprintf(stderr, "failed to write trace file %s\n", trace_path.c_str());
+        return 1;
+      }
+      trace_seconds += chrono::duration<double>(Clock::now() - end).count();
+    }
+  }
+  if (tracing && !trace.close()) {
+    fprintf(stderr, "failed to write trace file %s\n", trace_path.c_str());
+    return 1;
+  }
+
+  RopeMetrics metrics = measure(system, gravity);
+  double steps_per_second = steps / max(simulate_seconds, 1e-9);
+  printf("%s: %s, %ld steps of %g in %.3fs\n", integratorName(integrator),
+         label.c_str(), steps, delta_t, simulate_seconds);
+  printf("  %.0f steps/s, %.3g node-steps/s, %.1fx real time\n", steps_per_second,
+         steps_per_second * system.numMasses(), steps_per_second * delta_t);
+  printf("  final: kinetic %.6g, potential %.6g, max strain %.4g, max speed %.4g\n",
+         metrics.kinetic_energy, metrics.potential_energy, metrics.max_strain,
+         metrics.max_speed);
+  if (adaptive)
+    printf("  adaptive: %ld substeps (%.2f per step), substep %.3g .. %.3g\n", substeps,
+           (double)substeps / max(steps, 1L), min_dt, max_dt);
+  if (system.self_collision.radius > 0)
+    printf("  self-collision: %d contacts in the last step\n", system.self_collision.last_contacts);
+  if (tracing)
+    printf("  trace: %s (%.3fs)\n", trace_path.c_str(), trace_seconds);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  // 默认值与 AppConfig 相同：每帧 30 步，每帧 1 个时间单位
+  Integrator integrator = Integrator::Verlet;
+  int num_nodes = 9;
+  int num_ropes = 1;
+  int cloth_size = 0;
+  float mass = 1;
+  float ks = 0.1;
+  Vector2D gravity(0, -1);
+  double delta_t = 1.0 / 30;
+  long steps = 1000;
+  int xpbd_iterations = 10;
+  double collision_radius = 0;
+  bool adaptive = false;
+  string trace_path;
+  int state_interval = 0;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "i:n:c:w:m:k:g:t:N:x:r:ao:d:")) != -1) {
+    switch (opt) {
+    case 'i':
+      if (!parseIntegrator(optarg, integrator)) {
+        fprintf(stderr, "unknown integrator '%s'\n", optarg);
+        return 1;
+      }
+      break;
+    case 'n':
+      num_nodes = max(atoi(optarg), 2); // 与 addRope 一致，至少两个质点
+      break;
+    case 'c':
+      num_ropes = max(atoi(optarg), 1);
+      break;
+    case 'w':
+      cloth_size = atoi(optarg);
+      break;
+    case 'm':
+      mass = atof(optarg);
+      break;
+    case 'k':
+      ks = atof(optarg);
+      break;
+    case 'g':
+      if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+      }
+      gravity = Vector2D(atof(argv[optind - 1]), atof(argv[optind]));
+      optind++;
+      break;
+    case 't':
+      delta_t = atof(optarg);
+      break;
+    case 'N':
+      steps = atol(optarg);
+      break;
+    case 'x':
+      xpbd_iterations = atoi(optarg);
+      break;
+    case 'r':
+      collision_radius = atof(optarg);
+      break;
+    case 'a':
+      adaptive = true;
+      break;
+    case 'o':
+      trace_path = optarg;
+      break;
+    case 'd':
+      state_interval = atoi(optarg);
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  char label[64];
+  if (cloth_size > 1) {
+    // 水平的布料，两个角钉住，下方有一个球和地面
+    double spacing = 300.0 / (cloth_size - 1);
+    Cloth cloth(Vector3D(-150, 500, -150), Vector3D(spacing, 0, 0), Vector3D(0, 0, spacing),
+                cloth_size, cloth_size, mass, ks, ks, ks * 0.1);
+    cloth.pin(cloth.index(0, 0));
+    cloth.pin(cloth.index(cloth_size - 1, 0));
+    CollisionSphere sphere = {Vector3D(0, 350, 0), 80, 0.2};
+    CollisionPlane ground = {Vector3D(0, 0, 0), Vector3D(0, 1, 0), 0.5};
+    cloth.spheres.push_back(sphere);
+    cloth.planes.push_back(ground);
+    cloth.xpbd.iterations = xpbd_iterations;
+    cloth.self_collision.radius = collision_radius;
+    snprintf(label, sizeof(label), "%d x %d cloth", cloth_size, cloth_size);
+    AdaptiveTimestep<Vector3D> substeps;
+    return run(cloth, label, integrator, Vector3D(gravity.x, gravity.y, 0), delta_t,
+               steps, trace_path, state_interval, adaptive ? &substeps : NULL);
+  }
+
+  // 所有绳子放在同一个质点池里，每根绳子的第一个节点钉住
+  Rope rope;
+  rope.reserve((size_t)num_ropes * num_nodes, (size_t)num_ropes * (num_nodes - 1));
+  for (int c = 0; c < num_ropes; c++) {
+    Vector2D offset(0, -10.0 * c);
+    Rope::Range range = rope.addRope(Vector2D(0, 500) + offset, Vector2D(300, 500) + offset,
+                                     num_nodes, mass, ks);
+    rope.pin(range.first);
+  }
+  rope.xpbd.iterations = xpbd_iterations;
+  rope.self_collision.radius = collision_radius;
+  snprintf(label, sizeof(label), "%d x %d nodes", num_ropes, num_nodes);
+  AdaptiveTimestep<Vector2D> substeps;
+  return run(rope, label, integrator, gravity, delta_t, steps, trace_path,
+             state_interval, adaptive ? &substeps : NULL);
+}
@@ -0,0 +1,398 @@
+#ifndef IMPLICIT_H
+#define IMPLICIT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "mass_spring.h"
+
+using namespace std;
+
+namespace CGL {
+
+// D x D 的稠密小块
+template <int D> struct Block {
+  double m[D][D];
+
+  void setZero() {
+    for (int r = 0; r < D; r++)
+      for (int c = 0; c < D; c++)
+        m[r][c] = 0;
+  }
+};
+
+// 按块存放的 CSR 稀疏矩阵（BSR）：第 i 行的非零块是对角块和所有与质点 i 有弹簧相连的质点。
+// 绳子上每行只有 左、对角、右 三个块，即块三对角矩阵；网格布料是一般的稀疏结构，用同一套存储
+template <int D> class BlockSparseMatrix {
+public:
+  // 由弹簧建立稀疏结构，并记下每根弹簧的 (m1, m2)、(m2, m1) 两个块的位置，
+  // 之后每一步组装时按弹簧直接写入，不需要查找
+  void buildPattern(const SpringArrays &springs, size_t num_masses) {
+    vector<vector<uint32_t> > neighbours(num_masses);
+    for (size_t s = 0; s < springs.size(); s++) {
+      neighbours[springs.m1[s]].push_back(springs.m2[s]);
+      neighbours[springs.m2[s]].push_back(springs.m1[s]);
+    }
+    row_start.assign(num_masses + 1, 0);
+    cols.clear();
+    diag_index.resize(num_masses);
+    for (size_t i = 0; i < num_masses; i++) {
+      vector<uint32_t> &row = neighbours[i];
+      row.push_back(i);
+      sort(row.begin(), row.end());
+      row.erase(unique(row.begin(), row.end()), row.end());
+      for (size_t j = 0; j < row.size(); j++) {
+        if (row[j] == i)
+          diag_index[i] = cols.size();
+        cols.push_back(row[j]);
+      }
+      row_start[i + 1] = cols.size();
+    }
+    blocks.resize(cols.size());
+    spring_ab.resize(springs.size());
+    spring_ba.resize(springs.size());
+    for (size_t s = 0; s < springs.size(); s++) {
+      spring_ab[s] = index(springs.m1[s], springs.m2[s]);
+      spring_ba[s] = index(springs.m2[s], springs.m1[s]);
+    }
+    topology = springs.topology;
+    tridiagonal = true;
+    for (size_t i = 0; i < num_masses && tridiagonal; i++)
+      for (uint32_t k = row_start[i]; k < row_start[i + 1]; k++)
+        if (cols[k] + 1 < i || cols[k] > i + 1)
+          tridiagonal = false;
+  }
+
+  bool matches(const SpringArrays &springs, size_t num_masses) const {
+    return topology == springs.topology && rows() == num_masses;
+  }
+
+  size_t rows() const { return row_start.empty() ? 0 : row_start.size() - 1; }
+
+  void setZero() {
+    for (size_t i = 0; i < blocks.size(); i++)
+      blocks[i].setZero();
+  }
+
+  // y = A x，按行并行，每行只写自己的 y
+  void multiply(const double *x, double *y) const {
+    const int n = (int)rows();
+#pragma omp parallel for schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      double sum[D] = {0};
+      for (uint32_t k = row_start[i]; k < row_start[i + 1]; k++) {
+        const Block<D> &b = blocks[k];
+        const double *xj = x + D * cols[k];
+        for (int r = 0; r < D; r++)
+          for (int c = 0; c < D; c++)
+            sum[r] += b.m[r][c] * xj[c];
+      }
+      for (int r = 0; r < D; r++)
+        y[D * i + r] = sum[r];
+    }
+  }
+
+  vector<uint32_t> row_start, cols, diag_index;
+  vector<Block<D> > blocks;
+  vector<uint32_t> spring_ab, spring_ba;
+  // 只有 (i, i-1)、(i, i)、(i, i+1) 块非零（节点按顺序编号的绳子）
+  bool tridiagonal = false;
+
+  // (row, col) 块的位置，不存在时返回 -1
+  int index(uint32_t row, uint32_t col) const {
+    for (uint32_t k = row_start[row]; k < row_start[row + 1]; k++)
+      if (cols[k] == col)
+        return k;
+    return -1;
+  }
+
+private:
+  uint32_t topology = 0; // 建立稀疏结构时弹簧的着色版本，0 表示还没有建立
+};
+
+// D x D 对称正定块求逆（块 Jacobi 预条件子），D 为 2 或 3
+template <int D> inline Block<D> inverse(const Block<D> &a);
+
+template <> inline Block<2> inverse(const Block<2> &a) {
+  Block<2> r;
+  double inv_det = 1.0 / (a.m[0][0] * a.m[1][1] - a.m[0][1] * a.m[1][0]);
+  r.m[0][0] = a.m[1][1] * inv_det;
+  r.m[0][1] = -a.m[0][1] * inv_det;
+  r.m[1][0] = -a.m[1][0] * inv_det;
+  r.m[1][1] = a.m[0][0] * inv_det;
+  return r;
+}
+
+template <> inline Block<3> inverse(const Block<3> &a) {
+  const double(*m)[3] = a.m;
+  Block<3> r;
+  r.m[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+  r.m[0][1] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+  r.m[0][2] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+  r.m[1][0] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+  r.m[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+  r.m[1][2] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+  r.m[2][0] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+  r.m[2][1] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+  r.m[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+  double inv_det =
+      1.0 / (m[0][0] * r.m[0][0] + m[0][1] * r.m[1][0] + m[0][2] * r.m[2][0]);
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      r.m[i][j] *= inv_det;
+  return r;
+}
+
+template <int D> inline Block<D> operator*(const Block<D> &a, const Block<D> &b) {
+  Block<D> r;
+  for (int i = 0; i < D; i++)
+    for (int j = 0; j < D; j++) {
+      r.m[i][j] = 0;
+      for (int k = 0; k < D; k++)
+        r.m[i][j] += a.m[i][k] * b.m[k][j];
+    }
+  return r;
+}
+
+// y = a x
+template <int D> inline void multiply(const Block<D> &a, const double *x, double *y) {
+  for (int i = 0; i < D; i++) {
+    y[i] = 0;
+    for (int j = 0; j < D; j++)
+      y[i] += a.m[i][j] * x[j];
+  }
+}
+
+inline double dotProduct(const vector<double> &a, const vector<double> &b) {
+  const int n = (int)a.size();
+  double sum = 0;
+#pragma omp parallel for reduction(+ : sum) schedule(static) if (n >= kParallelGrain)
+  for (int i = 0; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+// 隐式（后向）欧拉：每一步解线性方程组
+//   (M - h * df/dv - h^2 * df/dx) dv = h * (f0 + h * df/dx * v0)
+// 然后 v += dv，x += h * v。矩阵对称正定：绳子的矩阵是块三对角的，用块追赶法（Thomas）直接求解，O(n)；
+// 一般的网格用块 Jacobi 预条件的共轭梯度法求解。
+// 被钉住的质点对应的行列换成单位阵、右端为 0，保证它们的 dv = 0 且矩阵仍然对称
+template <int D> class ImplicitSolver {
+public:
+  int max_iterations = 200;
+  double tolerance = 1e-6; // 相对残差 |r| / |b|
+
+  int last_iterations = 0; // 上一步共轭梯度的迭代次数，直接求解时为 0
+  double last_residual = 0;
+  bool last_direct = false; // 上一步是否用块追赶法直接求解
+
+  // Vec 的内存布局必须是连续的 D 个 double（Vector2D / Vector3D）
+  template <typename Vec>
+  void step(const SpringArrays &springs, Vec *positions, Vec *velocities,
+            const double *inv_masses, size_t num_masses, const Vec &gravity,
+            double h, double damping) {
+    static_assert(sizeof(Vec) == D * sizeof(double), "Vec must be D doubles");
+    if (!A.matches(springs, num_masses))
+      A.buildPattern(springs, num_masses);
+
+    const int n = (int)num_masses;
+    const size_t dofs = D * num_masses;
+    b.assign(dofs, 0);
+    dv.assign(dofs, 0);
+
+    // f0：重力、弹簧力和阻尼
+    forces.assign(dofs, 0);
+    accumulateSpringForces(springs, positions, velocities, damping,
+                           reinterpret_cast<Vec *>(&forces[0]));
+
+    // 对角块先放质量
+    A.setZero();
+    for (int i = 0; i < n; i++) {
+      Block<D> &diag = A.blocks[A.diag_index[i]];
+      double mass = inv_masses[i] > 0 ? 1.0 / inv_masses[i] : 1.0;
+      for (int r = 0; r < D; r++)
+        diag.m[r][r] = mass;
+      if (inv_masses[i] > 0) {
+        const double *f = &forces[D * i];
+        const double *g = reinterpret_cast<const double *>(&gravity);
+        for (int r = 0; r < D; r++)
+          b[D * i + r] = h * (f[r] + g[r] * mass);
+      }
+    }
+
+    // 每根弹簧贡献 J = h^2 * Ks + h * c * I：
+    //   Ks = k * ((1 - L/l) * I + (L/l) * d d^T)，d 为单位方向；
+    //   压缩时 1 - L/l < 0 会使矩阵不定，截断为 0（Choi & Ko 2002）
+    // A 的 (a,a)、(b,b) 加 J，(a,b)、(b,a) 减 J；右端 b_a -= h^2 * Ks (v_a - v_b)，b_b 相反
+    const double *x = reinterpret_cast<const double *>(positions);
+    const double *v = reinterpret_cast<const double *>(velocities);
+    for (int c = 0; c < (int)springs.colors.size(); c++) {
+      const uint32_t *batch = springs.colors[c].data();
+      const int count = (int)springs.colors[c].size();
+      const bool parallel = count >= kParallelGrain && c != springs.serial_color;
+#pragma omp parallel for schedule(static) if (parallel)
+      for (int j = 0; j < count; j++) {
+        uint32_t s = batch[j], ia = springs.m1[s], ib = springs.m2[s];
+        double d[D], length2 = 0;
+        for (int r = 0; r < D; r++) {
+          d[r] = x[D * ib + r] - x[D * ia + r];
+          length2 += d[r] * d[r];
+        }
+        double length = sqrt(length2);
+        double ratio = springs.rest_length[s] / length;
+        double k = springs.k[s];
+        double iso = k * max(0.0, 1.0 - ratio);
+        Block<D> Ks, J;
+        for (int r = 0; r < D; r++)
+          for (int col = 0; col < D; col++) {
+            Ks.m[r][col] = k * ratio * d[r] * d[col] / length2 + (r == col ? iso : 0);
+            J.m[r][col] = h * h * Ks.m[r][col] + (r == col ? h * damping : 0);
+          }
+        bool pa = inv_masses[ia] > 0, pb = inv_masses[ib] > 0;
+        for (int r = 0; r < D; r++) {
+          double kv = 0;
+          for (int col = 0; col < D; col++)
+            kv += Ks.m[r][col] * (v[D * ia + col] - v[D * ib + col]);
+          if (pa)
+            b[D * ia + r] -= h * h * kv;
+          if (pb)
+            b[D * ib + r] += h * h * kv;
+        }
+        // 同一颜色批次内各弹簧的端点互不相同，写对角块不会冲突；非对角块每根弹簧独占
+        for (int r = 0; r < D; r++)
+          for (int col = 0; col < D; col++) {
+            if (pa)
+              A.blocks[A.diag_index[ia]].m[r][col] += J.m[r][col];
+            if (pb)
+              A.blocks[A.diag_index[ib]].m[r][col] += J.m[r][col];
+            if (pa && pb) {
+              A.blocks[A.spring_ab[s]].m[r][col] -= J.m[r][col];
+              A.blocks[A.spring_ba[s]].m[r][col] -= J.m[r][col];
+            }
+          }
+      }
+    }
+
+    last_direct = A.tridiagonal;
+    if (A.tridiagonal)
+      solveTridiagonal(n);
+    else
+      solve(n);
+
+    Vec *dvec = reinterpret_cast<Vec *>(&dv[0]);
+#pragma omp parallel for schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      velocities[i] += dvec[i];
+      positions[i] += velocities[i] * h;
+    }
+  }
+
+private:
+  // 块 Jacobi 预条件的共轭梯度，dv 初值为 0
+  void solve(int n) {
+    const int dofs = D * n;
+    preconditioner.resize(n);
+    for (int i = 0; i < n; i++)
+      preconditioner[i] = inverse(A.blocks[A.diag_index[i]]);
+
+    r = b;
+    z.resize(dofs);
+    p.resize(dofs);
+    Ap.resize(dofs);
+    applyPreconditioner(r, z);
+    p = z;
+    double rz = dotProduct(r, z);
+    double b_norm = sqrt(dotProduct(b, b));
+    last_iterations = 0;
+    last_residual = 0;
+    if (b_norm == 0)
+      return;
+    for (int it = 0; it < max_iterations; it++) {
+      A.multiply(&p[0], &Ap[0]);
+      double alpha = rz / dotProduct(p, Ap);
+#pragma omp parallel for schedule(static) if (dofs >= kParallelGrain)
+      for (int i = 0; i < dofs; i++) {
+        dv[i] += alpha * p[i];
+        r[i] -= alpha * Ap[i];
+      }
+      last_iterations = it + 1;
+      last_residual = sqrt(dotProduct(r, r)) / b_norm;
+      if (last_residual < tolerance)
+        break;
+      applyPreconditioner(r, z);
+      double rz_new = dotProduct(r, z);
+      double beta = rz_new / rz;
+      rz = rz_new;
+#pragma omp parallel for schedule(static) if (dofs >= kParallelGrain)
+      for (int i = 0; i < dofs; i++)
+        p[i] = z[i] + beta * p[i];
+    }
+  }
+
+  // 块追赶法：A = L U 分解时依次消去下对角块，再回代。对称正定矩阵不需要选主元
+  void solveTridiagonal(int n) {
+    last_iterations = 0;
+    last_residual = 0;
+    upper.resize(n);
+    vector<double> &y = r; // 消元后的右端
+    y = b;
+    Block<D> zero;
+    zero.setZero();
+    for (int i = 0; i < n; i++) {
+      Block<D> pivot = A.blocks[A.diag_index[i]];
+      if (i > 0) {
+        int k = A.index(i, i - 1);
+        if (k >= 0) {
+          const Block<D> &lower = A.blocks[k];
+          Block<D> lu = lower * upper[i - 1];
+          for (int row = 0; row < D; row++)
+            for (int c = 0; c < D; c++)
+              pivot.m[row][c] -= lu.m[row][c];
+          double t[D];
+          multiply(lower, &y[D * (i - 1)], t);
+          for (int row = 0; row < D; row++)
+            y[D * i + row] -= t[row];
+        }
+      }
+      Block<D> inv = inverse(pivot);
+      int k = i + 1 < n ? A.index(i, i + 1) : -1;
+      upper[i] = k >= 0 ? inv * A.blocks[k] : zero;
+      double t[D];
+      multiply(inv, &y[D * i], t);
+      for (int row = 0; row < D; row++)
+        y[D * i + row] = t[row];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      double t[D] = {0};
+      if (i + 1 < n)
+        multiply(upper[i], &dv[D * (i + 1)], t);
+      for (int row = 0; row < D; row++)
+        dv[D * i + row] = y[D * i + row] - t[row];
+    }
+  }
+
+  void applyPreconditioner(const vector<double> &in, vector<double> &out) const {
+    const int n = (int)preconditioner.size();
+#pragma omp parallel for schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      const Block<D> &P = preconditioner[i];
+      for (int row = 0; row < D; row++) {
+        double sum = 0;
+        for (int c = 0; c < D; c++)
+          sum += P.m[row][c] * in[D * i + c];
+        out[D * i + row] = sum;
+      }
+    }
+  }
+
+  BlockSparseMatrix<D> A;
+  vector<Block<D> > preconditioner;
+  vector<Block<D> > upper; // 追赶法中消元后的上对角块 U_i = M_i^{-1} C_i
+  vector<double> forces, b, dv, r, z, p, Ap;
+};
+
+} // namespace CGL
+
+#endif /* IMPLICIT_H */
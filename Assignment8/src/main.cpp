@@ -16,6 +16,8 @@ void usage(const char *binaryName) {
   printf("  -m  <FLOAT>            Mass per node\n");
   printf("  -g  <FLOAT> <FLOAT>    Gravity vector (x, y)\n");
   printf("  -s  <INT>              Number of steps per simulation frame\n");
+  printf("  -n  <INT>              Number of nodes per rope\n");
+  printf("  -A                     Adaptive substeps per frame (toggle with the A key)\n");
   printf("\n");
 }
 
@@ -24,7 +26,7 @@ int main(int argc, char **argv) {
 
   int opt;
 
-  while ((opt = getopt(argc, argv, "s:l:t:m:e:h:f:r:c:a:p:")) != -1) {
+  while ((opt = getopt(argc, argv, "s:l:t:m:e:h:f:r:c:a:p:n:A")) != -1) {
     switch (opt) {
     case 'm':
       config.mass = atof(optarg);
@@ -36,6 +38,12 @@ int main(int argc, char **argv) {
     case 's':
       config.steps_per_frame = atoi(optarg);
       break;
+    case 'n':
+      config.num_nodes = atoi(optarg);
+      break;
+    case 'A':
+      config.adaptive_steps = true;
+      break;
     default:
       usage(argv[0]);
       return 1;
@@ -57,5 +65,6 @@ int main(int argc, char **argv) {
   // start viewer
   viewer.start();
 
+  delete app;
   return 0;
 }
@@ -1,7 +1,6 @@
 #ifndef MASS_H
 #define MASS_H
 
-#include "CGL/CGL.h"
 #include "CGL/vector2D.h"
 
 using namespace CGL;
@@ -0,0 +1,145 @@
+#ifndef MASS_SPRING_H
+#define MASS_SPRING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace CGL {
+
+// 积分方式
+enum class Integrator { Euler, Verlet, Implicit, XPBD };
+
+// "euler" / "verlet" / "implicit" / "xpbd"，不认识时返回 false
+inline bool parseIntegrator(const string &name, Integrator &integrator) {
+  const char *names[] = {"euler", "verlet", "implicit", "xpbd"};
+  for (int i = 0; i < 4; i++) {
+    if (name == names[i]) {
+      integrator = Integrator(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+inline const char *integratorName(Integrator integrator) {
+  const char *names[] = {"euler", "verlet", "implicit", "xpbd"};
+  return names[int(integrator)];
+}
+
+// 少于这么多个弹簧/质点的循环不开 OpenMP 线程，9 个节点的演示绳子开线程反而更慢
+const int kParallelGrain = 4096;
+
+// 弹簧的 SoA 存储：端点是质点数组的下标，不再保存 Mass 指针
+struct SpringArrays {
+  vector<uint32_t> m1, m2;
+  vector<double> rest_length;
+  vector<float> k;
+
+  // 按图着色分成的批次：同一批里的弹簧没有公共端点，并行往端点上累加力时不会写冲突。
+  // 绳子只需要两种颜色（奇数段、偶数段）
+  vector<vector<uint32_t> > colors;
+
+  size_t size() const { return m1.size(); }
+  size_t capacity() const { return m1.capacity(); }
+
+  void reserve(size_t n) {
+    m1.reserve(n);
+    m2.reserve(n);
+    rest_length.reserve(n);
+    k.reserve(n);
+  }
+
+  void add(uint32_t a, uint32_t b, float stiffness, double rest) {
+    m1.push_back(a);
+    m2.push_back(b);
+    k.push_back(stiffness);
+    rest_length.push_back(rest);
+    colors_valid = false;
+  }
+
+  void clear() {
+    m1.clear();
+    m2.clear();
+    rest_length.clear();
+    k.clear();
+    colors.clear();
+    colors_valid = false;
+  }
+
+  // 增删弹簧之后需要重新着色
+  bool colored() const { return colors_valid; }
+
+  // 贪心着色：每根弹簧取两个端点都还没用过的最小颜色。
+  // 颜色用 64 位掩码记录，超出 64 种颜色的弹簧放进最后一批串行处理
+  void buildColors(size_t num_masses) {
+    vector<uint64_t> used(num_masses, 0);
+    colors.assign(1, vector<uint32_t>());
+    vector<uint32_t> overflow;
+    for (uint32_t s = 0; s < size(); s++) {
+      uint64_t free_colors = ~(used[m1[s]] | used[m2[s]]);
+      if (free_colors == 0) {
+        overflow.push_back(s);
+        continue;
+      }
+      int c = __builtin_ctzll(free_colors);
+      if (c >= (int)colors.size())
+        colors.resize(c + 1);
+      colors[c].push_back(s);
+      used[m1[s]] |= uint64_t(1) << c;
+      used[m2[s]] |= uint64_t(1) << c;
+    }
+    serial_color = overflow.empty() ? -1 : (int)colors.size();
+    if (!overflow.empty())
+      colors.push_back(overflow);
+    colors_valid = true;
+    topology++;
+  }
+
+  // 需要串行处理的那一批（没有时为 -1）
+  int serial_color = -1;
+  // 每次重新着色加一，依赖弹簧结构的缓存（例如隐式积分的稀疏矩阵）据此判断是否过期
+  uint32_t topology = 0;
+
+private:
+  bool colors_valid = false;
+};
+
+// 一根弹簧作用在 m1 上的力（m2 受到的是它的相反数）：胡克定律 + 阻尼。
+// 原来的写法是 -c * 沿弹簧方向的相对速度 + c * 切向的相对速度（取反），两项合起来就是 -c * (v1 - v2)
+template <typename Vec>
+inline Vec springForce(const Vec &p1, const Vec &p2, const Vec &v1,
+                       const Vec &v2, double k, double rest_length,
+                       double damping) {
+  Vec m1tom2 = p2 - p1;
+  double length = m1tom2.norm();
+  return m1tom2 * (k * (length - rest_length) / length) - (v1 - v2) * damping;
+}
+
+// 把所有弹簧力累加到 forces 上。按颜色逐批处理，每批内部并行；
+// 每个质点上各弹簧力的相加顺序只由着色决定，结果与线程数无关
+template <typename Vec>
+void accumulateSpringForces(const SpringArrays &springs, const Vec *positions,
+                            const Vec *velocities, double damping,
+                            Vec *forces) {
+  for (int c = 0; c < (int)springs.colors.size(); c++) {
+    const uint32_t *batch = springs.colors[c].data();
+    const int n = (int)springs.colors[c].size();
+    const bool parallel = n >= kParallelGrain && c != springs.serial_color;
+#pragma omp parallel for schedule(static) if (parallel)
+    for (int j = 0; j < n; j++) {
+      uint32_t s = batch[j], a = springs.m1[s], b = springs.m2[s];
+      Vec f = springForce(positions[a], positions[b], velocities[a],
+                          velocities[b], springs.k[s],
+                          springs.rest_length[s], damping);
+      forces[a] += f;
+      forces[b] -= f;
+    }
+  }
+}
+
+} // namespace CGL
+
+#endif /* MASS_SPRING_H */
@@ -0,0 +1,258 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mass_spring.h"
+
+using namespace std;
+
+namespace CGL {
+
+// 质点和弹簧的内存池：所有质点属性、弹簧属性各自存放在一个连续数组里，用 32 位下标互相引用。
+// 绳子、网格（布料）、晶格都是一次调用整批创建，每个数组只分配一次；
+// 析构时整块释放，不存在单独 new 出来、需要逐个 delete 的对象
+template <typename Vec> class ParticleSystem {
+public:
+  // 一次批量创建得到的质点下标区间 [first, first + count)
+  struct Range {
+    uint32_t first, count;
+  };
+
+  size_t numMasses() const { return positions.size(); }
+
+  void reserve(size_t masses, size_t num_springs) {
+    positions.reserve(masses);
+    last_positions.reserve(masses);
+    velocities.reserve(masses);
+    forces.reserve(masses);
+    inv_masses.reserve(masses);
+    springs.reserve(num_springs);
+  }
+
+  uint32_t addMass(const Vec &position, double mass, bool pinned = false) {
+    positions.push_back(position);
+    last_positions.push_back(position);
+    velocities.push_back(Vec());
+    forces.push_back(Vec());
+    inv_masses.push_back(pinned ? 0.0 : 1.0 / mass);
+    return positions.size() - 1;
+  }
+
+  // 静止长度取两个质点当前的距离
+  void addSpring(uint32_t a, uint32_t b, float k) {
+    springs.add(a, b, k, (positions[b] - positions[a]).norm());
+  }
+
+  // 被钉住的质点逆质量为 0，同时停下来（速度清零、Verlet 的上一位置与当前位置一致），
+  // 否则隐式积分仍会按残留速度移动它
+  void pin(uint32_t i) {
+    inv_masses[i] = 0;
+    velocities[i] = Vec();
+    last_positions[i] = positions[i];
+  }
+
+  // 从 start 到 end 均匀分布的 num_nodes 个质点，相邻质点之间一根弹簧
+  Range addRope(const Vec &start, const Vec &end, int num_nodes, double mass,
+                float k) {
+    num_nodes = num_nodes > 1 ? num_nodes : 2;
+    Range range = grow(num_nodes, num_nodes - 1);
+    Vec step = (end - start) / (num_nodes - 1);
+    for (int i = 0; i < num_nodes; i++)
+      setMass(range.first + i, start + step * i, mass);
+    for (int i = 0; i + 1 < num_nodes; i++)
+      addSpring(range.first + i, range.first + i + 1, k);
+    return range;
+  }
+
+  // nu x nv 的网格，质点 (i, j) 位于 origin + i * du + j * dv，下标为 first + j * nu + i。
+  // 结构弹簧连接上下左右，剪切弹簧连接两条对角线，弯曲弹簧隔一个点连接；刚度为 0 的那一类不创建
+  Range addGrid(const Vec &origin, const Vec &du, const Vec &dv, int nu, int nv,
+                double mass, float k_structural, float k_shear, float k_bend) {
+    size_t num_springs = 0;
+    if (k_structural > 0)
+      num_springs += (nu - 1) * nv + nu * (nv - 1);
+    if (k_shear > 0)
+      num_springs += 2 * (nu - 1) * (nv - 1);
+    if (k_bend > 0)
+      num_springs += max(nu - 2, 0) * nv + nu * max(nv - 2, 0);
+    Range range = grow(nu * nv, num_springs);
+    for (int j = 0; j < nv; j++)
+      for (int i = 0; i < nu; i++)
+        setMass(range.first + j * nu + i, origin + du * i + dv * j, mass);
+    for (int j = 0; j < nv; j++)
+      for (int i = 0; i < nu; i++) {
+        uint32_t p = range.first + j * nu + i;
+        if (k_structural > 0) {
+          if (i + 1 < nu)
+            addSpring(p, p + 1, k_structural);
+          if (j + 1 < nv)
+            addSpring(p, p + nu, k_structural);
+        }
+        if (k_shear > 0 && i + 1 < nu && j + 1 < nv) {
+          addSpring(p, p + nu + 1, k_shear);
+          addSpring(p + 1, p + nu, k_shear);
+        }
+        if (k_bend > 0) {
+          if (i + 2 < nu)
+            addSpring(p, p + 2, k_bend);
+          if (j + 2 < nv)
+            addSpring(p, p + 2 * nu, k_bend);
+        }
+      }
+    return range;
+  }
+
+  // nu x nv x nw 的晶格（软体），质点 (i, j, l) 的下标为 first + (l * nv + j) * nu + i。
+  // 结构弹簧连接六个方向的相邻点，剪切弹簧连接三个坐标面上的面对角线
+  Range addLattice(const Vec &origin, const Vec &du, const Vec &dv,
+                   const Vec &dw, int nu, int nv, int nw, double mass,
+                   float k_structural, float k_shear) {
+    size_t num_springs = 0;
+    if (k_structural > 0)
+      num_springs += (nu - 1) * nv * nw + nu * (nv - 1) * nw + nu * nv * (nw - 1);
+    if (k_shear > 0)
+      num_springs += 2 * ((nu - 1) * (nv - 1) * nw + (nu - 1) * nv * (nw - 1) +
+                          nu * (nv - 1) * (nw - 1));
+    Range range = grow(nu * nv * nw, num_springs);
+    const int su = 1, sv = nu, sw = nu * nv; // 三个方向上相邻质点的下标差
+    for (int l = 0; l < nw; l++)
+      for (int j = 0; j < nv; j++)
+        for (int i = 0; i < nu; i++)
+          setMass(range.first + l * sw + j * sv + i,
+                  origin + du * i + dv * j + dw * l, mass);
+    for (int l = 0; l < nw; l++)
+      for (int j = 0; j < nv; j++)
+        for (int i = 0; i < nu; i++) {
+          uint32_t p = range.first + l * sw + j * sv + i;
+          bool u = i + 1 < nu, v = j + 1 < nv, w = l + 1 < nw;
+          if (k_structural > 0) {
+            if (u) addSpring(p, p + su, k_structural);
+            if (v) addSpring(p, p + sv, k_structural);
+            if (w) addSpring(p, p + sw, k_structural);
+          }
+          if (k_shear > 0) {
+            if (u && v) {
+              addSpring(p, p + su + sv, k_shear);
+              addSpring(p + su, p + sv, k_shear);
+            }
+            if (u && w) {
+              addSpring(p, p + su + sw, k_shear);
+              addSpring(p + su, p + sw, k_shear);
+            }
+            if (v && w) {
+              addSpring(p, p + sv + sw, k_shear);
+              addSpring(p + sv, p + sw, k_shear);
+            }
+          }
+        }
+    return range;
+  }
+
+  // 清空所有质点和弹簧，保留已分配的容量，下一次构建不需要重新分配
+  void clear() {
+    positions.clear();
+    last_positions.clear();
+    velocities.clear();
+    forces.clear();
+    inv_masses.clear();
+    springs.clear();
+  }
+
+  // 清空并归还所有内存
+  void release() {
+    ParticleSystem empty;
+    swap(empty);
+  }
+
+  void swap(ParticleSystem &other) {
+    positions.swap(other.positions);
+    last_positions.swap(other.last_positions);
+    velocities.swap(other.velocities);
+    forces.swap(other.forces);
+    inv_masses.swap(other.inv_masses);
+    std::swap(springs, other.springs);
+  }
+
+  // 模拟前调用：弹簧有增减时重新着色
+  void prepare() {
+    if (!springs.colored())
+      springs.buildColors(numMasses());
+  }
+
+  // 显式（半隐式）欧拉：先按着色批次并行累加弹簧力和阻尼，再逐个质点积分。
+  // 逐元素的积分没有分支，编译器可以向量化；被钉住的质点 w = 0，加速度（包括重力）为 0
+  void stepEuler(double delta_t, const Vec &gravity, double damping) {
+    accumulateSpringForces(springs, positions.data(), velocities.data(), damping, forces.data());
+    Vec *x = positions.data(), *v = velocities.data(), *f = forces.data();
+    const double *w = inv_masses.data();
+    const int n = (int)numMasses();
+#pragma omp parallel for simd schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      double movable = w[i] > 0 ? 1.0 : 0.0;
+      Vec a = f[i] * w[i] + gravity * movable;
+      v[i] += a * delta_t;  // semi-implicit euler method (order 1)
+      x[i] += v[i] * delta_t;
+      f[i] = Vec();         // 每一步受力都重新计算
+    }
+  }
+
+  // 显式 Verlet：x' = 2x - x_last + a dt^2。被钉住的质点加速度为 0 且 last_position 与 position 相同，位置保持不变
+  void stepVerlet(double delta_t, const Vec &gravity, double damping) {
+    accumulateSpringForces(springs, positions.data(), velocities.data(), damping, forces.data());
+    Vec *x = positions.data(), *x_last = last_positions.data();
+    Vec *v = velocities.data(), *f = forces.data();
+    const double *w = inv_masses.data();
+    const int n = (int)numMasses();
+#pragma omp parallel for simd schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      double movable = w[i] > 0 ? 1.0 : 0.0;
+      Vec a = f[i] * w[i] + gravity * movable;
+      Vec temp = x[i];
+      v[i] += a * delta_t;
+      x[i] = x[i] * 2 - x_last[i] + a * (delta_t * delta_t);
+      x_last[i] = temp;
+      f[i] = Vec();
+    }
+  }
+
+  // 质点（SoA）
+  vector<Vec> positions;
+  vector<Vec> last_positions; // explicit Verlet integration
+  vector<Vec> velocities;     // explicit Euler integration
+  vector<Vec> forces;
+  vector<double> inv_masses; // 质量的倒数，被钉住的质点为 0
+
+  // 弹簧
+  SpringArrays springs;
+
+private:
+  // 一次性为 masses 个质点、num_springs 根弹簧预留空间，新质点追加到数组末尾。
+  // 容量按倍数增长，连续创建很多小的绳子时总的复制量仍是线性的
+  Range grow(size_t masses, size_t num_springs) {
+    Range range = {(uint32_t)numMasses(), (uint32_t)masses};
+    size_t n = numMasses() + masses;
+    size_t m = springs.size() + num_springs;
+    if (springs.capacity() < m)
+      springs.reserve(max(m, 2 * springs.capacity()));
+    positions.resize(n);
+    last_positions.resize(n);
+    velocities.resize(n, Vec());
+    forces.resize(n, Vec());
+    inv_masses.resize(n);
+    return range;
+  }
+
+  void setMass(uint32_t i, const Vec &position, double mass) {
+    positions[i] = position;
+    last_positions[i] = position;
+    inv_masses[i] = 1.0 / mass;
+  }
+};
+
+} // namespace CGL
+
+#endif /* PARTICLE_SYSTEM_H */
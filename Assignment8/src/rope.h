@@ -1,26 +1,46 @@
 #ifndef ROPE_H
 #define ROPE_H
 
-#include "CGL/CGL.h"
+#include <string>
+
+#include "CGL/vector2D.h"
+#include "implicit.h"
 #include "mass.h"
+#include "mass_spring.h"
+#include "particle_system.h"
+#include "spatial_hash.h"
 #include "spring.h"
+#include "xpbd.h"
 
 using namespace std;
 
 namespace CGL {
 
-class Rope {
+// 一根（或几根）绳子：质点和弹簧存放在 ParticleSystem 的连续数组里，弹簧用端点下标表示。
+// 模拟时只顺序扫描连续数组，不再追 Mass* / Spring* 指针
+class Rope : public ParticleSystem<Vector2D> {
 public:
-  Rope(vector<Mass *> &masses, vector<Spring *> &springs)
-      : masses(masses), springs(springs) {}
+  // 空的系统，之后用 addRope / addGrid / addLattice 批量添加
+  Rope() {}
+  // 从已有的 Mass / Spring 拷贝出 SoA 数组，不接管它们的所有权
+  Rope(vector<Mass *> &masses, vector<Spring *> &springs);
   Rope(Vector2D start, Vector2D end, int num_nodes, float node_mass, float k,
        vector<int> pinned_nodes);
 
   void simulateVerlet(float delta_t, Vector2D gravity);
   void simulateEuler(float delta_t, Vector2D gravity);
+  // 隐式（后向）欧拉，弹簧很硬或步长很大（例如每帧一步）时仍然稳定
+  void simulateImplicit(float delta_t, Vector2D gravity);
+  // XPBD：弹簧作为带柔度的距离约束求解，迭代次数和求解方式见 xpbd
+  void simulateXPBD(float delta_t, Vector2D gravity);
+  // 按 integrator 积分一步，再处理质点之间的自碰撞
+  void simulate(Integrator integrator, float delta_t, Vector2D gravity);
 
-  vector<Mass *> masses;
-  vector<Spring *> springs;
+  // 隐式积分的稀疏矩阵和共轭梯度的工作区，第一次调用时按弹簧建立
+  ImplicitSolver<2> implicit;
+  XPBDSolver<Vector2D> xpbd;
+  // 质点之间的自碰撞，radius 为 0（默认）时关闭
+  SelfCollision<Vector2D> self_collision;
 }; // struct Rope
 }
 #endif /* ROPE_H */
@@ -0,0 +1,218 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "mass_spring.h"
+#include "particle_system.h"
+
+using namespace std;
+
+namespace CGL {
+
+// 均匀网格的空间哈希（宽阶段）：每一步重建，网格边长取碰撞半径，
+// 与某个质点距离小于半径的质点一定落在它周围 3^D 个格子里，查询只看这些格子，整体接近线性。
+// 格子坐标哈希到 2 的幂大小的桶表，桶内的质点按计数排序连续存放（cell_start / entries，类似 CSR）
+template <typename Vec> class SpatialHash {
+public:
+  static const int D = sizeof(Vec) / sizeof(double);
+
+  // 计数排序：质点按线程数分块，每块单独统计每个桶的个数，再按 (桶, 块) 的顺序求前缀和后各块并行写入。
+  // 同一个桶里的质点保持下标顺序，结果与线程数无关
+  void build(const Vec *positions, size_t n, double cell) {
+    cell_size = cell;
+    inv_cell_size = 1.0 / cell;
+    size_t table = 1;
+    while (table < 2 * n)
+      table <<= 1;
+    mask = table - 1;
+
+    const int count = (int)n;
+    keys.resize(n);
+#pragma omp parallel for schedule(static) if (count >= kParallelGrain)
+    for (int i = 0; i < count; i++) {
+      int c[D];
+      cellOf(positions[i], c);
+      keys[i] = bucket(c);
+    }
+
+    int chunks = 1;
+#ifdef _OPENMP
+    if (count >= kParallelGrain)
+      chunks = omp_get_max_threads();
+#endif
+    chunk_offsets.assign((size_t)chunks * table, 0);
+#pragma omp parallel for schedule(static, 1) if (chunks > 1)
+    for (int c = 0; c < chunks; c++) {
+      uint32_t *counts = &chunk_offsets[(size_t)c * table];
+      for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; i++)
+        counts[keys[i]]++;
+    }
+    cell_start.resize(table + 1);
+    uint32_t sum = 0;
+    for (size_t b = 0; b < table; b++) {
+      cell_start[b] = sum;
+      for (int c = 0; c < chunks; c++) {
+        uint32_t &slot = chunk_offsets[(size_t)c * table + b];
+        uint32_t k = slot;
+        slot = sum;
+        sum += k;
+      }
+    }
+    cell_start[table] = sum;
+    entries.resize(n);
+#pragma omp parallel for schedule(static, 1) if (chunks > 1)
+    for (int c = 0; c < chunks; c++) {
+      uint32_t *offsets = &chunk_offsets[(size_t)c * table];
+      for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; i++)
+        entries[offsets[keys[i]]++] = i;
+    }
+  }
+
+  // 对 p 周围 3^D 个格子中的每个质点调用 f(j)（包括距离超过半径的、以及 p 自己），由调用者判断距离。
+  // 不同格子可能哈希到同一个桶，每个桶只访问一次
+  template <typename F> void forEachNeighbour(const Vec &p, F f) const {
+    int center[D];
+    cellOf(p, center);
+    uint32_t visited[27];
+    int num_visited = 0;
+    int total = 1;
+    for (int d = 0; d < D; d++)
+      total *= 3;
+    for (int k = 0; k < total; k++) {
+      int c[D];
+      for (int d = 0, r = k; d < D; d++, r /= 3)
+        c[d] = center[d] + r % 3 - 1;
+      uint32_t b = bucket(c);
+      if (find(visited, visited + num_visited, b) != visited + num_visited)
+        continue;
+      visited[num_visited++] = b;
+      for (uint32_t e = cell_start[b]; e < cell_start[b + 1]; e++)
+        f(entries[e]);
+    }
+  }
+
+  double cell_size = 0;
+  vector<uint32_t> cell_start; // 第 b 个桶的质点为 entries[cell_start[b], cell_start[b + 1])
+  vector<uint32_t> entries;
+
+private:
+  void cellOf(const Vec &p, int c[D]) const {
+    const double *x = reinterpret_cast<const double *>(&p);
+    for (int d = 0; d < D; d++)
+      c[d] = (int)floor(x[d] * inv_cell_size);
+  }
+
+  uint32_t bucket(const int c[D]) const {
+    static const uint32_t primes[3] = {73856093u, 19349663u, 83492791u};
+    uint32_t h = 0;
+    for (int d = 0; d < D; d++)
+      h ^= (uint32_t)c[d] * primes[d];
+    return h & mask;
+  }
+
+  double inv_cell_size = 1;
+  uint32_t mask = 0;
+  vector<uint32_t> keys, chunk_offsets;
+};
+
+// 质点之间的自碰撞：距离小于 radius 的两个质点沿连线推开到 radius，并去掉相互靠近的法向速度，
+// 按逆质量分配修正量。由弹簧直接相连的质点不参与（它们的静止距离可能小于 radius）。
+// 每个质点只读其他质点上一轮的位置、只写自己的修正量，可以并行且结果与线程数无关
+template <typename Vec> class SelfCollision {
+public:
+  double radius = 0; // 0 表示不做自碰撞
+
+  int last_contacts = 0; // 上一步发生接触的质点对数（每对计两次）
+
+  void apply(ParticleSystem<Vec> &system, double delta_t) {
+    if (radius <= 0)
+      return;
+    const int n = (int)system.numMasses();
+    if (topology != system.springs.topology || (int)adjacency_start.size() != n + 1)
+      buildAdjacency(system.springs, n);
+    grid.build(system.positions.data(), n, radius);
+
+    const Vec *x = system.positions.data();
+    const Vec *v = system.velocities.data();
+    const double *w = system.inv_masses.data();
+    dx.assign(n, Vec());
+    dv.assign(n, Vec());
+    int contacts = 0;
+#pragma omp parallel for schedule(static) reduction(+ : contacts) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      if (w[i] == 0)
+        continue;
+      const uint32_t *adj_begin = adjacency.data() + adjacency_start[i];
+      const uint32_t *adj_end = adjacency.data() + adjacency_start[i + 1];
+      Vec xi = x[i], vi = v[i];
+      Vec &dxi = dx[i], &dvi = dv[i];
+      grid.forEachNeighbour(xi, [&](uint32_t j) {
+        if ((int)j == i)
+          return;
+        Vec d = xi - x[j];
+        double dist2 = d.norm2();
+        if (dist2 >= radius * radius || dist2 == 0)
+          return;
+        if (binary_search(adj_begin, adj_end, j))
+          return;
+        double dist = sqrt(dist2);
+        Vec normal = d / dist;
+        double share = w[i] / (w[i] + w[j]);
+        dxi += normal * ((radius - dist) * share);
+        double vn = dot(vi - v[j], normal);
+        if (vn < 0)
+          dvi -= normal * (vn * share);
+        contacts++;
+      });
+    }
+    last_contacts = contacts;
+
+    // Verlet 由 x - x_last 隐含速度，x_last 跟着移动 dx - dv * dt，隐含速度同样加上 dv
+    Vec *xs = system.positions.data(), *x_last = system.last_positions.data();
+    Vec *vs = system.velocities.data();
+#pragma omp parallel for schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      xs[i] += dx[i];
+      vs[i] += dv[i];
+      x_last[i] += dx[i] - dv[i] * delta_t;
+    }
+  }
+
+private:
+  // 每个质点通过弹簧直接相连的质点，按下标排序
+  void buildAdjacency(const SpringArrays &springs, int n) {
+    adjacency_start.assign(n + 1, 0);
+    for (size_t s = 0; s < springs.size(); s++) {
+      adjacency_start[springs.m1[s] + 1]++;
+      adjacency_start[springs.m2[s] + 1]++;
+    }
+    for (int i = 0; i < n; i++)
+      adjacency_start[i + 1] += adjacency_start[i];
+    adjacency.resize(adjacency_start[n]);
+    vector<uint32_t> fill(adjacency_start.begin(), adjacency_start.end() - 1);
+    for (size_t s = 0; s < springs.size(); s++) {
+      adjacency[fill[springs.m1[s]]++] = springs.m2[s];
+      adjacency[fill[springs.m2[s]]++] = springs.m1[s];
+    }
+    for (int i = 0; i < n; i++)
+      sort(adjacency.begin() + adjacency_start[i], adjacency.begin() + adjacency_start[i + 1]);
+    topology = springs.topology;
+  }
+
+  SpatialHash<Vec> grid;
+  vector<uint32_t> adjacency_start, adjacency;
+  uint32_t topology = 0;
+  vector<Vec> dx, dv;
+};
+
+} // namespace CGL
+
+#endif /* SPATIAL_HASH_H */
@@ -1,7 +1,6 @@
 #ifndef SPRING_H
 #define SPRING_H
 
-#include "CGL/CGL.h"
 #include "mass.h"
 
 using namespace std;
@@ -0,0 +1,109 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "particle_system.h"
+
+using namespace std;
+
+namespace CGL {
+
+// 每一步的统计量
+struct RopeMetrics {
+  double kinetic_energy;   // sum 1/2 m v^2
+  double potential_energy; // 弹性势能 sum 1/2 k (l - L)^2 加重力势能 sum -m g.x
+  double max_strain;       // max |l - L| / L
+  double max_speed;
+};
+
+// 被钉住的质点不计入能量和速度
+template <typename Vec>
+RopeMetrics measure(const ParticleSystem<Vec> &rope, const Vec &gravity) {
+  const int n = (int)rope.numMasses();
+  const int m = (int)rope.springs.size();
+  double kinetic = 0, potential = 0, max_speed2 = 0, max_strain = 0;
+#pragma omp parallel for reduction(+ : kinetic, potential) reduction(max : max_speed2) if (n >= kParallelGrain)
+  for (int i = 0; i < n; i++) {
+    double w = rope.inv_masses[i];
+    if (w == 0)
+      continue;
+    double speed2 = rope.velocities[i].norm2();
+    kinetic += 0.5 * speed2 / w;
+    potential -= dot(gravity, rope.positions[i]) / w;
+    max_speed2 = max(max_speed2, speed2);
+  }
+  const SpringArrays &s = rope.springs;
+#pragma omp parallel for reduction(+ : potential) reduction(max : max_strain) if (m >= kParallelGrain)
+  for (int j = 0; j < m; j++) {
+    double stretch = (rope.positions[s.m2[j]] - rope.positions[s.m1[j]]).norm() - s.rest_length[j];
+    potential += 0.5 * s.k[j] * stretch * stretch;
+    max_strain = max(max_strain, fabs(stretch) / s.rest_length[j]);
+  }
+  RopeMetrics metrics = {kinetic, potential, max_strain, sqrt(max_speed2)};
+  return metrics;
+}
+
+// 二进制轨迹文件（本机字节序）：
+//   文件头：魔数 "ROPETRC2"、uint32 维数（2 或 3）、uint32 质点数、uint32 弹簧数、uint32 积分方式、
+//           uint32 状态间隔、double 步长
+//   每一步一条记录：uint32 步号、uint32 是否带状态、double 时间、RopeMetrics 的 4 个 double，
+//   带状态时后面跟着所有质点的位置（每个质点 维数 个 double）。
+// 状态间隔为 0 时只写统计量
+class TraceWriter {
+public:
+  TraceWriter() : fp(NULL), state_interval(0) {}
+  ~TraceWriter() { close(); }
+
+  template <typename Vec>
+  bool open(const string &path, const ParticleSystem<Vec> &rope,
+            Integrator integrator, double delta_t, uint32_t interval) {
+    close();
+    fp = fopen(path.c_str(), "wb");
+    if (!fp)
+      return false;
+    state_interval = interval;
+    uint32_t header[5] = {(uint32_t)(sizeof(Vec) / sizeof(double)),
+                          (uint32_t)rope.numMasses(), (uint32_t)rope.springs.size(),
+                          (uint32_t)integrator, interval};
+    return fwrite(kMagic, 1, 8, fp) == 8 &&
+           fwrite(header, sizeof(header), 1, fp) == 1 &&
+           fwrite(&delta_t, sizeof(delta_t), 1, fp) == 1;
+  }
+
+  template <typename Vec>
+  bool write(uint32_t step, double time, const RopeMetrics &metrics,
+             const ParticleSystem<Vec> &rope) {
+    uint32_t has_state = state_interval > 0 && step % state_interval == 0;
+    uint32_t head[2] = {step, has_state};
+    double values[5] = {time, metrics.kinetic_energy, metrics.potential_energy,
+                        metrics.max_strain, metrics.max_speed};
+    bool ok = fwrite(head, sizeof(head), 1, fp) == 1 &&
+              fwrite(values, sizeof(values), 1, fp) == 1;
+    if (ok && has_state)
+      ok = fwrite(rope.positions.data(), sizeof(Vec), rope.numMasses(), fp) == rope.numMasses();
+    return ok;
+  }
+
+  bool close() {
+    if (!fp)
+      return true;
+    bool ok = fclose(fp) == 0;
+    fp = NULL;
+    return ok;
+  }
+
+private:
+  static constexpr const char *kMagic = "ROPETRC2"; // 只写前 8 个字节，不含结尾的 0
+
+  FILE *fp;
+  uint32_t state_interval;
+};
+
+} // namespace CGL
+
+#endif /* TRACE_H */
@@ -0,0 +1,140 @@
+#ifndef XPBD_H
+#define XPBD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "mass_spring.h"
+
+using namespace std;
+
+namespace CGL {
+
+// 约束的迭代方式
+enum class ConstraintSolve {
+  GaussSeidel, // 按着色批次依次求解，批内并行；每条约束立即看到前面批次的修正
+  Jacobi       // 所有约束同时用上一轮的位置求解，修正量乘以松弛系数后一起加上
+};
+
+// XPBD（Macklin et al. 2016）：弹簧变成距离约束 C = |x_a - x_b| - L，柔度 alpha = 1 / k。
+// 每一步先按重力预测位置，再迭代投影约束，最后由位移反推速度。
+// 约束的硬度由柔度决定，与迭代次数、步长无关；被钉住的质点逆质量为 0（无穷大质量），不会被约束移动
+template <typename Vec> class XPBDSolver {
+public:
+  int iterations = 10;
+  ConstraintSolve mode = ConstraintSolve::GaussSeidel;
+  double jacobi_relaxation = 0.5; // Jacobi 模式下修正量的松弛系数
+  double damping = 0.01;          // 全局速度阻尼（每单位时间衰减的比例）
+
+  // 积分一步，last_positions 写入步前的位置，与 Verlet 的约定一致
+  void step(const SpringArrays &springs, Vec *positions, Vec *last_positions,
+            Vec *velocities, const double *inv_masses, size_t num_masses,
+            const Vec &gravity, double h) {
+    const int n = (int)num_masses;
+    const double velocity_scale = max(0.0, 1.0 - damping * h);
+
+    // 预测：只受重力
+#pragma omp parallel for schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++) {
+      last_positions[i] = positions[i];
+      if (inv_masses[i] > 0) {
+        velocities[i] += gravity * h;
+        positions[i] += velocities[i] * h;
+      }
+    }
+
+    lambda.assign(springs.size(), 0);
+    if (mode == ConstraintSolve::Jacobi)
+      delta_lambda.resize(springs.size());
+    const double inv_h2 = 1.0 / (h * h);
+    for (int it = 0; it < iterations; it++) {
+      if (mode == ConstraintSolve::GaussSeidel)
+        solveGaussSeidel(springs, positions, inv_masses, inv_h2);
+      else
+        solveJacobi(springs, positions, inv_masses, inv_h2);
+    }
+
+    // 由位移得到速度
+#pragma omp parallel for schedule(static) if (n >= kParallelGrain)
+    for (int i = 0; i < n; i++)
+      velocities[i] = (positions[i] - last_positions[i]) * (velocity_scale / h);
+  }
+
+private:
+  // 一条约束的拉格朗日乘子增量，n 返回约束梯度方向（从 b 指向 a 的单位向量）
+  static double deltaLambda(const Vec &pa, const Vec &pb, double wa, double wb,
+                            double rest_length, double alpha_tilde,
+                            double lambda, Vec &n) {
+    Vec d = pa - pb;
+    double length = d.norm();
+    n = Vec();
+    double w = wa + wb + alpha_tilde;
+    // 柔度无穷大（k <= 0）的约束不起作用
+    if (length == 0 || w == 0 || std::isinf(alpha_tilde))
+      return 0;
+    n = d / length;
+    double C = length - rest_length;
+    return (-C - alpha_tilde * lambda) / w;
+  }
+
+  // alpha / h^2 = 1 / (k h^2)；k <= 0 时为无穷大
+  static double complianceTerm(float k, double inv_h2) {
+    return k > 0 ? inv_h2 / k : std::numeric_limits<double>::infinity();
+  }
+
+  void solveGaussSeidel(const SpringArrays &springs, Vec *x,
+                        const double *w, double inv_h2) {
+    for (int c = 0; c < (int)springs.colors.size(); c++) {
+      const uint32_t *batch = springs.colors[c].data();
+      const int count = (int)springs.colors[c].size();
+      const bool parallel = count >= kParallelGrain && c != springs.serial_color;
+#pragma omp parallel for schedule(static) if (parallel)
+      for (int j = 0; j < count; j++) {
+        uint32_t s = batch[j], a = springs.m1[s], b = springs.m2[s];
+        Vec n;
+        double dl = deltaLambda(x[a], x[b], w[a], w[b], springs.rest_length[s],
+                                complianceTerm(springs.k[s], inv_h2), lambda[s], n);
+        lambda[s] += dl;
+        x[a] += n * (w[a] * dl);
+        x[b] -= n * (w[b] * dl);
+      }
+    }
+  }
+
+  void solveJacobi(const SpringArrays &springs, Vec *x, const double *w,
+                   double inv_h2) {
+    // 先用本轮开始时的位置算出所有约束的修正量，再按着色批次无冲突地加到质点上
+    const int m = (int)springs.size();
+    directions.resize(m);
+#pragma omp parallel for schedule(static) if (m >= kParallelGrain)
+    for (int s = 0; s < m; s++) {
+      uint32_t a = springs.m1[s], b = springs.m2[s];
+      delta_lambda[s] = jacobi_relaxation *
+                        deltaLambda(x[a], x[b], w[a], w[b], springs.rest_length[s],
+                                    complianceTerm(springs.k[s], inv_h2),
+                                    lambda[s], directions[s]);
+      lambda[s] += delta_lambda[s];
+    }
+    for (int c = 0; c < (int)springs.colors.size(); c++) {
+      const uint32_t *batch = springs.colors[c].data();
+      const int count = (int)springs.colors[c].size();
+      const bool parallel = count >= kParallelGrain && c != springs.serial_color;
+#pragma omp parallel for schedule(static) if (parallel)
+      for (int j = 0; j < count; j++) {
+        uint32_t s = batch[j], a = springs.m1[s], b = springs.m2[s];
+        x[a] += directions[s] * (w[a] * delta_lambda[s]);
+        x[b] -= directions[s] * (w[b] * delta_lambda[s]);
+      }
+    }
+  }
+
+  vector<double> lambda, delta_lambda;
+  vector<Vec> directions;
+};
+
+} // namespace CGL
+
+#endif /* XPBD_H */